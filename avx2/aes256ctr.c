@@ -80,25 +80,98 @@ static inline void aesni_encrypt8(unsigned char *out,
   _mm_storeu_si128((__m128i*)(out+112), temp7);
 }
 
-void aes256ctr_init(aes256ctr_ctx *state,
-                    const unsigned char *key,
-                    uint16_t nonce)
+/* Encrypt 2 consecutive counter blocks for each of 4 nonces, 8 blocks
+   interleaved as in aesni_encrypt8 */
+static inline void aesni_encrypt4x2(unsigned char *out[4],
+                                    __m128i n[4],
+                                    const __m128i rkeys[16])
+{
+  unsigned int i, j;
+  __m128i temp[8];
+  const __m128i bswap = _mm_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7);
+
+  for(j = 0; j < 4; ++j) {
+    temp[2*j+0] = _mm_shuffle_epi8(n[j], bswap);
+    temp[2*j+1] = _mm_shuffle_epi8(_mm_add_epi32(n[j], _mm_set_epi64x(1,0)), bswap);
+    n[j] = _mm_add_epi32(n[j], _mm_set_epi64x(2,0));
+  }
+
+  for(j = 0; j < 8; ++j)
+    temp[j] = _mm_xor_si128(temp[j], rkeys[0]);
+
+  for(i = 1; i < 14; ++i)
+    for(j = 0; j < 8; ++j)
+      temp[j] = _mm_aesenc_si128(temp[j], rkeys[i]);
+
+  for(j = 0; j < 8; ++j)
+    temp[j] = _mm_aesenclast_si128(temp[j], rkeys[14]);
+
+  for(j = 0; j < 4; ++j) {
+    _mm_storeu_si128((__m128i*)(out[j]+ 0), temp[2*j+0]);
+    _mm_storeu_si128((__m128i*)(out[j]+16), temp[2*j+1]);
+    out[j] += 32;
+  }
+}
+
+#ifdef __VAES__
+/* Same with 256-bit VAES, 4 consecutive counter blocks for each of 4 nonces
+   in 8 registers of 2 blocks each */
+static inline void vaes_encrypt4x4(unsigned char *out[4],
+                                   __m128i n[4],
+                                   const __m128i rkeys[16])
+{
+  unsigned int i, j;
+  __m128i c0, c1, c2, c3;
+  __m256i rk, temp[8];
+  const __m128i bswap = _mm_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7);
+
+  for(j = 0; j < 4; ++j) {
+    c0 = _mm_shuffle_epi8(n[j], bswap);
+    c1 = _mm_shuffle_epi8(_mm_add_epi32(n[j], _mm_set_epi64x(1,0)), bswap);
+    c2 = _mm_shuffle_epi8(_mm_add_epi32(n[j], _mm_set_epi64x(2,0)), bswap);
+    c3 = _mm_shuffle_epi8(_mm_add_epi32(n[j], _mm_set_epi64x(3,0)), bswap);
+    temp[2*j+0] = _mm256_set_m128i(c1, c0);
+    temp[2*j+1] = _mm256_set_m128i(c3, c2);
+    n[j] = _mm_add_epi32(n[j], _mm_set_epi64x(4,0));
+  }
+
+  rk = _mm256_broadcastsi128_si256(rkeys[0]);
+  for(j = 0; j < 8; ++j)
+    temp[j] = _mm256_xor_si256(temp[j], rk);
+
+  for(i = 1; i < 14; ++i) {
+    rk = _mm256_broadcastsi128_si256(rkeys[i]);
+    for(j = 0; j < 8; ++j)
+      temp[j] = _mm256_aesenc_epi128(temp[j], rk);
+  }
+
+  rk = _mm256_broadcastsi128_si256(rkeys[14]);
+  for(j = 0; j < 8; ++j)
+    temp[j] = _mm256_aesenclast_epi128(temp[j], rk);
+
+  for(j = 0; j < 4; ++j) {
+    _mm256_storeu_si256((__m256i*)(out[j]+ 0), temp[2*j+0]);
+    _mm256_storeu_si256((__m256i*)(out[j]+32), temp[2*j+1]);
+    out[j] += 64;
+  }
+}
+#endif
+
+static void aes256_keyexpand(__m128i rkeys[16], const unsigned char *key)
 {
   __m128i key0 = _mm_loadu_si128((__m128i *)(key+0));
   __m128i key1 = _mm_loadu_si128((__m128i *)(key+16));
   __m128i temp0, temp1, temp2, temp4;
   int idx = 0;
 
-  state->n = _mm_set_epi64x(0, (uint64_t)(nonce >> 8 | nonce << 8) << 48);
-
-  state->rkeys[idx++] = key0;
+  rkeys[idx++] = key0;
   temp0 = key0;
   temp2 = key1;
   temp4 = _mm_setzero_si128();
 
 #define BLOCK1(IMM)                                                     \
   temp1 = _mm_aeskeygenassist_si128(temp2, IMM);                        \
-  state->rkeys[idx++] = temp2;                                          \
+  rkeys[idx++] = temp2;                                                 \
   temp4 = (__m128i)_mm_shuffle_ps((__m128)temp4, (__m128)temp0, 0x10);  \
   temp0 = _mm_xor_si128(temp0, temp4);                                  \
   temp4 = (__m128i)_mm_shuffle_ps((__m128)temp4, (__m128)temp0, 0x8c);  \
@@ -108,7 +181,7 @@ void aes256ctr_init(aes256ctr_ctx *state,
 
 #define BLOCK2(IMM)                                                     \
   temp1 = _mm_aeskeygenassist_si128(temp0, IMM);                        \
-  state->rkeys[idx++] = temp0;                                          \
+  rkeys[idx++] = temp0;                                                 \
   temp4 = (__m128i)_mm_shuffle_ps((__m128)temp4, (__m128)temp2, 0x10);  \
   temp2 = _mm_xor_si128(temp2, temp4);                                  \
   temp4 = (__m128i)_mm_shuffle_ps((__m128)temp4, (__m128)temp2, 0x8c);  \
@@ -135,7 +208,33 @@ void aes256ctr_init(aes256ctr_ctx *state,
   BLOCK2(0x20);
 
   BLOCK1(0x40);
-  state->rkeys[idx++] = temp0;
+  rkeys[idx++] = temp0;
+}
+
+static __m128i aes256ctr_counter(uint16_t nonce) {
+  return _mm_set_epi64x(0, (uint64_t)(nonce >> 8 | nonce << 8) << 48);
+}
+
+void aes256ctr_init(aes256ctr_ctx *state,
+                    const unsigned char *key,
+                    uint16_t nonce)
+{
+  state->n = aes256ctr_counter(nonce);
+  aes256_keyexpand(state->rkeys, key);
+}
+
+void aes256ctr4x_init(aes256ctr4x_ctx *state,
+                      const unsigned char *key,
+                      uint16_t nonce0,
+                      uint16_t nonce1,
+                      uint16_t nonce2,
+                      uint16_t nonce3)
+{
+  state->n[0] = aes256ctr_counter(nonce0);
+  state->n[1] = aes256ctr_counter(nonce1);
+  state->n[2] = aes256ctr_counter(nonce2);
+  state->n[3] = aes256ctr_counter(nonce3);
+  aes256_keyexpand(state->rkeys, key);
 }
 
 void aes256ctr_select(aes256ctr_ctx *state, uint16_t nonce) {
@@ -154,6 +253,29 @@ void aes256ctr_squeezeblocks(unsigned char *out,
   }
 }
 
+void aes256ctr4x_squeezeblocks(unsigned char *out0,
+                               unsigned char *out1,
+                               unsigned char *out2,
+                               unsigned char *out3,
+                               unsigned long long nblocks,
+                               aes256ctr4x_ctx *state)
+{
+  unsigned long long i;
+  unsigned char *out[4] = {out0, out1, out2, out3};
+
+  for(i=0;i<nblocks;i++) {
+#ifdef __VAES__
+    vaes_encrypt4x4(out, state->n, state->rkeys);
+    vaes_encrypt4x4(out, state->n, state->rkeys);
+#else
+    aesni_encrypt4x2(out, state->n, state->rkeys);
+    aesni_encrypt4x2(out, state->n, state->rkeys);
+    aesni_encrypt4x2(out, state->n, state->rkeys);
+    aesni_encrypt4x2(out, state->n, state->rkeys);
+#endif
+  }
+}
+
 void aes256ctr_prf(unsigned char *out,
                    unsigned long long outlen,
                    const unsigned char *seed,
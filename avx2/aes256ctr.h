@@ -9,6 +9,12 @@ typedef struct {
   __m128i n;
 } aes256ctr_ctx;
 
+/* Four AES-256-CTR streams with a common key and different nonces */
+typedef struct {
+  __m128i rkeys[16];
+  __m128i n[4];
+} aes256ctr4x_ctx;
+
 void aes256ctr_init(aes256ctr_ctx *state,
                     const unsigned char *key,
                     uint16_t nonce);
@@ -17,6 +23,19 @@ void aes256ctr_squeezeblocks(unsigned char *out,
                              unsigned long long nblocks,
                              aes256ctr_ctx *state);
 
+void aes256ctr4x_init(aes256ctr4x_ctx *state,
+                      const unsigned char *key,
+                      uint16_t nonce0,
+                      uint16_t nonce1,
+                      uint16_t nonce2,
+                      uint16_t nonce3);
+void aes256ctr4x_squeezeblocks(unsigned char *out0,
+                               unsigned char *out1,
+                               unsigned char *out2,
+                               unsigned char *out3,
+                               unsigned long long nblocks,
+                               aes256ctr4x_ctx *state);
+
 void aes256ctr_prf(unsigned char *out,
                    unsigned long long outlen,
                    const unsigned char *seed,
@@ -135,6 +135,31 @@ static void keccak_squeezeblocks4x(unsigned char *h0,
   DBENCH_STOP(*tshake);
 }
 
+static void keccak_absorb_lane4x(__m256i *s,
+                                 unsigned int j,
+                                 unsigned int r,
+                                 const unsigned char *m,
+                                 unsigned long long mlen,
+                                 unsigned char p)
+{
+  unsigned int i;
+  unsigned char t[200];
+  uint64_t *ss = (uint64_t *)s;
+
+  for(i = 0; i < r; ++i)
+    t[i] = 0;
+  for(i = 0; i < mlen; ++i)
+    t[i] = m[i];
+
+  t[i] = p;
+  t[r - 1] |= 128;
+
+  for(i = 0; i < r/8; ++i)
+    ss[4*i + j] = load64(t + 8*i);
+  for(i = r/8; i < 25; ++i)
+    ss[4*i + j] = 0;
+}
+
 void shake128_absorb4x(__m256i *s,
                        const unsigned char *m0,
                        const unsigned char *m1,
@@ -145,6 +170,14 @@ void shake128_absorb4x(__m256i *s,
   keccak_absorb4x(s, SHAKE128_RATE, m0, m1, m2, m3, mlen, 0x1F);
 }
 
+void shake128_absorb_lane4x(__m256i *s,
+                            unsigned int j,
+                            const unsigned char *m,
+                            unsigned long long mlen)
+{
+  keccak_absorb_lane4x(s, j, SHAKE128_RATE, m, mlen, 0x1F);
+}
+
 void shake128_squeezeblocks4x(unsigned char *h0,
                               unsigned char *h1,
                               unsigned char *h2,
@@ -246,3 +279,95 @@ void shake256_4x(unsigned char *h0,
     }
   }
 }
+
+/*************************************************
+* Name:        shake256_4x_varlen
+*
+* Description: SHAKE256 on four independent inputs of possibly different
+*              lengths, computed in the four lanes of a single 4-way Keccak
+*              state. Lanes that finish absorbing early are extracted right
+*              after their final permutation and then only ride along.
+*              Output length is limited to one block of SHAKE256_RATE bytes.
+*
+* Arguments:   - unsigned char *h0-h3: pointers to output buffers
+*              - unsigned long long hlen: number of output bytes per lane,
+*                                         at most SHAKE256_RATE
+*              - const unsigned char *m0-m3: pointers to inputs
+*              - unsigned long long mlen0-mlen3: input lengths
+**************************************************/
+void shake256_4x_varlen(unsigned char *h0,
+                        unsigned char *h1,
+                        unsigned char *h2,
+                        unsigned char *h3,
+                        unsigned long long hlen,
+                        const unsigned char *m0,
+                        const unsigned char *m1,
+                        const unsigned char *m2,
+                        const unsigned char *m3,
+                        unsigned long long mlen0,
+                        unsigned long long mlen1,
+                        unsigned long long mlen2,
+                        unsigned long long mlen3)
+{
+  unsigned int i, j;
+  unsigned long long blk, nblocks, maxblocks;
+  unsigned char t[SHAKE256_RATE];
+  unsigned char *h[4] = {h0, h1, h2, h3};
+  const unsigned char *m[4] = {m0, m1, m2, m3};
+  const unsigned long long mlen[4] = {mlen0, mlen1, mlen2, mlen3};
+  __m256i s[25];
+  uint64_t *ss = (uint64_t *)s;
+  DBENCH_START();
+
+  for(i = 0; i < 25; ++i)
+    s[i] = _mm256_setzero_si256();
+
+  /* Lane j absorbs mlen[j]/r full blocks plus one padded block */
+  maxblocks = 0;
+  for(j = 0; j < 4; ++j) {
+    nblocks = mlen[j]/SHAKE256_RATE + 1;
+    if(nblocks > maxblocks)
+      maxblocks = nblocks;
+  }
+
+  for(blk = 0; blk < maxblocks; ++blk) {
+    for(j = 0; j < 4; ++j) {
+      nblocks = mlen[j]/SHAKE256_RATE;
+      if(blk < nblocks) {
+        for(i = 0; i < SHAKE256_RATE/8; ++i)
+          ss[4*i + j] ^= load64(m[j] + blk*SHAKE256_RATE + 8*i);
+      }
+      else if(blk == nblocks) {
+        for(i = 0; i < SHAKE256_RATE; ++i)
+          t[i] = 0;
+        for(i = 0; i < mlen[j] - nblocks*SHAKE256_RATE; ++i)
+          t[i] = m[j][nblocks*SHAKE256_RATE + i];
+        t[i] = 0x1F;
+        t[SHAKE256_RATE - 1] |= 128;
+        for(i = 0; i < SHAKE256_RATE/8; ++i)
+          ss[4*i + j] ^= load64(t + 8*i);
+      }
+    }
+
+    KeccakF1600_StatePermute4x(s);
+
+    /* Lanes whose padded block was just permuted are done */
+    for(j = 0; j < 4; ++j) {
+      if(blk == mlen[j]/SHAKE256_RATE) {
+        for(i = 0; i < SHAKE256_RATE/8; ++i)
+          store64(t + 8*i, ss[4*i + j]);
+        for(i = 0; i < hlen; ++i)
+          h[j][i] = t[i];
+      }
+    }
+  }
+
+  DBENCH_STOP(*tshake);
+}
+
+void keccak_permute4x(__m256i *s)
+{
+  DBENCH_START();
+  KeccakF1600_StatePermute4x(s);
+  DBENCH_STOP(*tshake);
+}
@@ -11,6 +11,12 @@ void shake128_absorb4x(__m256i *s,
                        const unsigned char *m3,
                        unsigned long long mlen);
 
+/* Restart instance j alone with a message shorter than SHAKE128_RATE */
+void shake128_absorb_lane4x(__m256i *s,
+                            unsigned int j,
+                            const unsigned char *m,
+                            unsigned long long mlen);
+
 void shake128_squeezeblocks4x(unsigned char *h0,
                               unsigned char *h1,
                               unsigned char *h2,
@@ -32,6 +38,10 @@ void shake256_squeezeblocks4x(unsigned char *h0,
                               unsigned long nblocks,
                               __m256i *s);
 
+/* Squeeze one block in place: afterwards output word i of instance j is
+   lane j of s[i] */
+void keccak_permute4x(__m256i *s);
+
 void shake128_4x(unsigned char *h0,
                  unsigned char *h1,
                  unsigned char *h2,
@@ -54,4 +64,18 @@ void shake256_4x(unsigned char *h0,
                  const unsigned char *m3,
                  unsigned long long mlen);
 
+void shake256_4x_varlen(unsigned char *h0,
+                        unsigned char *h1,
+                        unsigned char *h2,
+                        unsigned char *h3,
+                        unsigned long long hlen,
+                        const unsigned char *m0,
+                        const unsigned char *m1,
+                        const unsigned char *m2,
+                        const unsigned char *m3,
+                        unsigned long long mlen0,
+                        unsigned long long mlen1,
+                        unsigned long long mlen2,
+                        unsigned long long mlen3);
+
 #endif
@@ -0,0 +1 @@
+../ref/matcache.c
\ No newline at end of file
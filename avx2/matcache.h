@@ -0,0 +1 @@
+../ref/matcache.h
\ No newline at end of file
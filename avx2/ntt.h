@@ -4,22 +4,17 @@
 #include <stdint.h>
 #include "params.h"
 
-extern const uint32_t zetas[N];
-extern const uint32_t zetas_inv[N];
+extern const uint32_t zetas_ntt32[576];
+extern const uint32_t zetas_inv_ntt32[576];
 
-void ntt_levels0t2_avx(uint64_t tmp[N],
-                       const uint32_t a[N],
-                       const uint32_t zetas[7]);
-void ntt_levels3t8_avx(uint32_t a[N],
-                       const uint64_t tmp[N],
-                       const uint32_t zetas[31]);
-
-void invntt_levels0t4_avx(uint64_t tmp[N],
-                          const uint32_t a[N],
-                          const uint32_t zetas_inv[31]);
-void invntt_levels5t7_avx(uint32_t a[N],
-                          const uint64_t tmp[N],
-                          const uint32_t zetas_inv[7]);
+void ntt32_avx(uint32_t a[N]);
+void ntt32x2_avx(uint32_t a0[N], uint32_t a1[N]);
+void ntt32x4_avx(uint32_t a0[N], uint32_t a1[N], uint32_t a2[N],
+                 uint32_t a3[N]);
+void invntt32_avx(uint32_t a[N]);
+void invntt32x2_avx(uint32_t a0[N], uint32_t a1[N]);
+void invntt32x4_avx(uint32_t a0[N], uint32_t a1[N], uint32_t a2[N],
+                    uint32_t a3[N]);
 
 void pointwise_avx(uint32_t c[N], const uint32_t a[N], const uint32_t b[N]);
 void pointwise_acc_avx(uint32_t c[N], const uint32_t *a, const uint32_t *b);
@@ -0,0 +1,466 @@
+#include <stdint.h>
+#include <immintrin.h>
+#include "params.h"
+#include "ntt.h"
+
+extern const uint32_t _8xqinv[8];
+extern const uint32_t _8xq[8];
+extern const uint32_t _8x2q[8];
+extern const uint32_t _8x256q[8];
+extern const uint32_t _8xdiv[8];
+
+/*
+ * NTT and inverse NTT computing the same values as the reference
+ * implementation. The coefficients stay in 32-bit lanes: a vector pair
+ * butterfly reduces the even and odd lanes with vpmuludq separately and
+ * blends the results, while the three levels with distance less than 8
+ * first permute every vector such that the two inputs of each butterfly
+ * share a 64-bit lane. Each transform makes two passes over the
+ * polynomial and no copy to a temporary buffer. The batched variants run
+ * the passes of 2 or 4 polynomials in lockstep, which shares the zeta
+ * loads and gives the processor independent butterflies to overlap.
+ */
+
+#define INLINE inline __attribute__((always_inline))
+
+/*************************************************
+* Name:        montmul
+*
+* Description: Montgomery multiplication of all coefficients of a with the
+*              zetas in the even lanes of z. Output coefficients are less
+*              than 2*Q if a*zeta < Q*2^32.
+*
+* Arguments:   - __m256i a: vector of coefficients
+*              - __m256i z: vector of zetas in even lanes
+*              - __m256i qinv: vector of -Q^{-1} mod 2^32
+*              - __m256i q: vector of Q
+*
+* Returns vector of products
+**************************************************/
+static inline __m256i montmul(__m256i a, __m256i z, __m256i qinv, __m256i q)
+{
+  __m256i t0, t1, m0, m1;
+
+  t0 = _mm256_mul_epu32(a, z);
+  t1 = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), z);
+  m0 = _mm256_mul_epu32(t0, qinv);
+  m1 = _mm256_mul_epu32(t1, qinv);
+  m0 = _mm256_mul_epu32(m0, q);
+  m1 = _mm256_mul_epu32(m1, q);
+  t0 = _mm256_add_epi64(t0, m0);
+  t1 = _mm256_add_epi64(t1, m1);
+  return _mm256_blend_epi32(_mm256_srli_epi64(t0, 32), t1, 0xAA);
+}
+
+/* Cooley-Tukey butterfly on the vectors a and b */
+#define CT(a, b, z)                                                     \
+  do {                                                                  \
+    __m256i t_ = montmul(b, z, qinv, q);                                \
+    b = _mm256_sub_epi32(_mm256_add_epi32(a, twoq), t_);                \
+    a = _mm256_add_epi32(a, t_);                                        \
+  } while(0)
+
+/* Gentleman-Sande butterfly on the vectors a and b */
+#define GS(a, b, z)                                                     \
+  do {                                                                  \
+    __m256i t_ = _mm256_sub_epi32(_mm256_add_epi32(a, c256q), b);       \
+    a = _mm256_add_epi32(a, b);                                         \
+    b = montmul(t_, z, qinv, q);                                        \
+  } while(0)
+
+/*************************************************
+* Name:        ct_lanes
+*
+* Description: Cooley-Tukey butterflies on the pairs of coefficients in the
+*              even and odd halves of each 64-bit lane of a.
+*
+* Arguments:   - __m256i a: vector of coefficients
+*              - __m256i z: vector of zetas in even lanes
+*              - __m256i qinv: vector of -Q^{-1} mod 2^32
+*              - __m256i q: vector of Q
+*              - __m256i twoq: vector of 2*Q
+*
+* Returns vector of outputs in the same lanes
+**************************************************/
+static inline __m256i ct_lanes(__m256i a, __m256i z, __m256i qinv, __m256i q,
+                               __m256i twoq)
+{
+  __m256i t, m, lo, hi;
+
+  t = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), z);
+  m = _mm256_mul_epu32(t, qinv);
+  m = _mm256_mul_epu32(m, q);
+  t = _mm256_add_epi64(t, m);
+  lo = _mm256_add_epi32(a, _mm256_srli_epi64(t, 32));
+  hi = _mm256_sub_epi32(_mm256_add_epi32(_mm256_slli_epi64(a, 32), twoq), t);
+  return _mm256_blend_epi32(lo, hi, 0xAA);
+}
+
+/*************************************************
+* Name:        gs_lanes
+*
+* Description: Gentleman-Sande butterflies on the pairs of coefficients in
+*              the even and odd halves of each 64-bit lane of a.
+*
+* Arguments:   - __m256i a: vector of coefficients
+*              - __m256i z: vector of zetas in even lanes
+*              - __m256i qinv: vector of -Q^{-1} mod 2^32
+*              - __m256i q: vector of Q
+*              - __m256i c256q: vector of 256*Q
+*
+* Returns vector of outputs in the same lanes
+**************************************************/
+static inline __m256i gs_lanes(__m256i a, __m256i z, __m256i qinv, __m256i q,
+                               __m256i c256q)
+{
+  __m256i b, s, t, m;
+
+  b = _mm256_srli_epi64(a, 32);
+  s = _mm256_add_epi32(a, b);
+  t = _mm256_sub_epi32(_mm256_add_epi32(a, c256q), b);
+  t = _mm256_mul_epu32(t, z);
+  m = _mm256_mul_epu32(t, qinv);
+  m = _mm256_mul_epu32(m, q);
+  t = _mm256_add_epi64(t, m);
+  return _mm256_blend_epi32(s, t, 0xAA);
+}
+
+/*************************************************
+* Name:        ntt_levels0t2
+*
+* Description: Levels 0 to 2 of the forward NTT on the vectors k, k+4, ...,
+*              k+28 of a polynomial.
+*
+* Arguments:   - uint32_t a[N]: input/output coefficient array
+*              - unsigned int k: index of first vector
+**************************************************/
+static INLINE void ntt_levels0t2(uint32_t a[N], unsigned int k) {
+  unsigned int i;
+  __m256i v[8], z;
+  const __m256i qinv = _mm256_load_si256((__m256i *)_8xqinv);
+  const __m256i q = _mm256_load_si256((__m256i *)_8xq);
+  const __m256i twoq = _mm256_load_si256((__m256i *)_8x2q);
+
+  for(i = 0; i < 8; ++i)
+    v[i] = _mm256_load_si256((__m256i *)&a[8*k + 32*i]);
+
+  z = _mm256_set1_epi32(zetas_ntt32[1]);
+  for(i = 0; i < 4; ++i)
+    CT(v[i], v[i + 4], z);
+
+  z = _mm256_set1_epi32(zetas_ntt32[2]);
+  CT(v[0], v[2], z);
+  CT(v[1], v[3], z);
+  z = _mm256_set1_epi32(zetas_ntt32[3]);
+  CT(v[4], v[6], z);
+  CT(v[5], v[7], z);
+
+  for(i = 0; i < 8; i += 2) {
+    z = _mm256_set1_epi32(zetas_ntt32[4 + i/2]);
+    CT(v[i], v[i + 1], z);
+  }
+
+  for(i = 0; i < 8; ++i)
+    _mm256_store_si256((__m256i *)&a[8*k + 32*i], v[i]);
+}
+
+/*************************************************
+* Name:        ntt_levels3t7
+*
+* Description: Levels 3 to 7 of the forward NTT on the vectors 4*k to 4*k+3
+*              of n polynomials.
+*
+* Arguments:   - uint32_t *a[]: array of n coefficient arrays
+*              - unsigned int n: number of polynomials, at most 4
+*              - unsigned int k: index of group of vectors
+**************************************************/
+static INLINE void ntt_levels3t7(uint32_t *a[], unsigned int n,
+                                 unsigned int k)
+{
+  unsigned int i, j;
+  __m256i v[4][4], z;
+  const __m256i qinv = _mm256_load_si256((__m256i *)_8xqinv);
+  const __m256i q = _mm256_load_si256((__m256i *)_8xq);
+  const __m256i twoq = _mm256_load_si256((__m256i *)_8x2q);
+  const __m256i idx5 = _mm256_set_epi32(7, 3, 6, 2, 5, 1, 4, 0);
+  const __m256i idx6 = _mm256_set_epi32(7, 3, 5, 1, 6, 2, 4, 0);
+
+  for(j = 0; j < n; ++j)
+    for(i = 0; i < 4; ++i)
+      v[j][i] = _mm256_load_si256((__m256i *)&a[j][32*k + 8*i]);
+
+  z = _mm256_set1_epi32(zetas_ntt32[8 + k]);
+  for(j = 0; j < n; ++j) {
+    CT(v[j][0], v[j][2], z);
+    CT(v[j][1], v[j][3], z);
+  }
+
+  z = _mm256_set1_epi32(zetas_ntt32[16 + 2*k]);
+  for(j = 0; j < n; ++j)
+    CT(v[j][0], v[j][1], z);
+  z = _mm256_set1_epi32(zetas_ntt32[17 + 2*k]);
+  for(j = 0; j < n; ++j)
+    CT(v[j][2], v[j][3], z);
+
+  for(i = 0; i < 4; ++i) {
+    /* Distance 4: lanes c0 c4 c1 c5 c2 c6 c3 c7 */
+    z = _mm256_set1_epi32(zetas_ntt32[32 + 4*k + i]);
+    for(j = 0; j < n; ++j) {
+      v[j][i] = _mm256_permutevar8x32_epi32(v[j][i], idx5);
+      v[j][i] = ct_lanes(v[j][i], z, qinv, q, twoq);
+    }
+
+    /* Distance 2: lanes c0 c2 c1 c3 c4 c6 c5 c7 */
+    z = _mm256_load_si256((__m256i *)&zetas_ntt32[64 + 32*k + 8*i]);
+    for(j = 0; j < n; ++j) {
+      v[j][i] = _mm256_permutevar8x32_epi32(v[j][i], idx6);
+      v[j][i] = ct_lanes(v[j][i], z, qinv, q, twoq);
+    }
+
+    /* Distance 1: natural order */
+    z = _mm256_load_si256((__m256i *)&zetas_ntt32[320 + 32*k + 8*i]);
+    for(j = 0; j < n; ++j) {
+      v[j][i] = _mm256_shuffle_epi32(v[j][i], 0xD8);
+      v[j][i] = ct_lanes(v[j][i], z, qinv, q, twoq);
+      _mm256_store_si256((__m256i *)&a[j][32*k + 8*i], v[j][i]);
+    }
+  }
+}
+
+/*************************************************
+* Name:        ntt_polys
+*
+* Description: Forward NTT of n polynomials with the passes in lockstep.
+*
+* Arguments:   - uint32_t *a[]: array of n coefficient arrays
+*              - unsigned int n: number of polynomials, at most 4
+**************************************************/
+static INLINE void ntt_polys(uint32_t *a[], unsigned int n) {
+  unsigned int j, k;
+
+  for(k = 0; k < 4; ++k)
+    for(j = 0; j < n; ++j)
+      ntt_levels0t2(a[j], k);
+
+  for(k = 0; k < 8; ++k)
+    ntt_levels3t7(a, n, k);
+}
+
+/*************************************************
+* Name:        invntt_levels0t4
+*
+* Description: Levels 0 to 4 of the inverse NTT on the vectors 4*k to
+*              4*k+3 of n polynomials.
+*
+* Arguments:   - uint32_t *a[]: array of n coefficient arrays
+*              - unsigned int n: number of polynomials, at most 4
+*              - unsigned int k: index of group of vectors
+**************************************************/
+static INLINE void invntt_levels0t4(uint32_t *a[], unsigned int n,
+                                    unsigned int k)
+{
+  unsigned int i, j;
+  __m256i v[4][4], z;
+  const __m256i qinv = _mm256_load_si256((__m256i *)_8xqinv);
+  const __m256i q = _mm256_load_si256((__m256i *)_8xq);
+  const __m256i c256q = _mm256_load_si256((__m256i *)_8x256q);
+  const __m256i idx5 = _mm256_set_epi32(7, 3, 5, 1, 6, 2, 4, 0);
+  const __m256i idx0 = _mm256_set_epi32(7, 5, 3, 1, 6, 4, 2, 0);
+
+  for(i = 0; i < 4; ++i) {
+    /* Distance 1: natural order */
+    z = _mm256_load_si256((__m256i *)&zetas_inv_ntt32[32*k + 8*i]);
+    for(j = 0; j < n; ++j) {
+      v[j][i] = _mm256_load_si256((__m256i *)&a[j][32*k + 8*i]);
+      v[j][i] = gs_lanes(v[j][i], z, qinv, q, c256q);
+    }
+
+    /* Distance 2: lanes c0 c2 c1 c3 c4 c6 c5 c7 */
+    z = _mm256_load_si256((__m256i *)&zetas_inv_ntt32[256 + 32*k + 8*i]);
+    for(j = 0; j < n; ++j) {
+      v[j][i] = _mm256_shuffle_epi32(v[j][i], 0xD8);
+      v[j][i] = gs_lanes(v[j][i], z, qinv, q, c256q);
+    }
+
+    /* Distance 4: lanes c0 c4 c1 c5 c2 c6 c3 c7 */
+    z = _mm256_set1_epi32(zetas_inv_ntt32[512 + 4*k + i]);
+    for(j = 0; j < n; ++j) {
+      v[j][i] = _mm256_permutevar8x32_epi32(v[j][i], idx5);
+      v[j][i] = gs_lanes(v[j][i], z, qinv, q, c256q);
+      v[j][i] = _mm256_permutevar8x32_epi32(v[j][i], idx0);
+    }
+  }
+
+  z = _mm256_set1_epi32(zetas_inv_ntt32[544 + 2*k]);
+  for(j = 0; j < n; ++j)
+    GS(v[j][0], v[j][1], z);
+  z = _mm256_set1_epi32(zetas_inv_ntt32[545 + 2*k]);
+  for(j = 0; j < n; ++j)
+    GS(v[j][2], v[j][3], z);
+
+  z = _mm256_set1_epi32(zetas_inv_ntt32[560 + k]);
+  for(j = 0; j < n; ++j) {
+    GS(v[j][0], v[j][2], z);
+    GS(v[j][1], v[j][3], z);
+  }
+
+  for(j = 0; j < n; ++j)
+    for(i = 0; i < 4; ++i)
+      _mm256_store_si256((__m256i *)&a[j][32*k + 8*i], v[j][i]);
+}
+
+/*************************************************
+* Name:        invntt_levels5t7
+*
+* Description: Levels 5 to 7 of the inverse NTT and multiplication by
+*              Montgomery factor on the vectors k, k+4, ..., k+28 of a
+*              polynomial.
+*
+* Arguments:   - uint32_t a[N]: input/output coefficient array
+*              - unsigned int k: index of first vector
+**************************************************/
+static INLINE void invntt_levels5t7(uint32_t a[N], unsigned int k) {
+  unsigned int i;
+  __m256i v[8], z;
+  const __m256i qinv = _mm256_load_si256((__m256i *)_8xqinv);
+  const __m256i q = _mm256_load_si256((__m256i *)_8xq);
+  const __m256i c256q = _mm256_load_si256((__m256i *)_8x256q);
+  const __m256i f = _mm256_load_si256((__m256i *)_8xdiv);
+
+  for(i = 0; i < 8; ++i)
+    v[i] = _mm256_load_si256((__m256i *)&a[8*k + 32*i]);
+
+  for(i = 0; i < 8; i += 2) {
+    z = _mm256_set1_epi32(zetas_inv_ntt32[568 + i/2]);
+    GS(v[i], v[i + 1], z);
+  }
+
+  z = _mm256_set1_epi32(zetas_inv_ntt32[572]);
+  GS(v[0], v[2], z);
+  GS(v[1], v[3], z);
+  z = _mm256_set1_epi32(zetas_inv_ntt32[573]);
+  GS(v[4], v[6], z);
+  GS(v[5], v[7], z);
+
+  z = _mm256_set1_epi32(zetas_inv_ntt32[574]);
+  for(i = 0; i < 4; ++i)
+    GS(v[i], v[i + 4], z);
+
+  for(i = 0; i < 8; ++i) {
+    v[i] = montmul(v[i], f, qinv, q);
+    _mm256_store_si256((__m256i *)&a[8*k + 32*i], v[i]);
+  }
+}
+
+/*************************************************
+* Name:        invntt_polys
+*
+* Description: Inverse NTT of n polynomials with the passes in lockstep.
+*
+* Arguments:   - uint32_t *a[]: array of n coefficient arrays
+*              - unsigned int n: number of polynomials, at most 4
+**************************************************/
+static INLINE void invntt_polys(uint32_t *a[], unsigned int n) {
+  unsigned int j, k;
+
+  for(k = 0; k < 8; ++k)
+    invntt_levels0t4(a, n, k);
+
+  for(k = 0; k < 4; ++k)
+    for(j = 0; j < n; ++j)
+      invntt_levels5t7(a[j], k);
+}
+
+/*************************************************
+* Name:        ntt32_avx
+*
+* Description: Forward NTT, in-place. Same output as the reference
+*              implementation, in particular output coefficients can be up
+*              to 16*Q larger than the input coefficients. Output vector is
+*              in bitreversed order.
+*
+* Arguments:   - uint32_t a[N]: input/output coefficient array
+*                               (32-byte aligned)
+**************************************************/
+void ntt32_avx(uint32_t a[N]) {
+  ntt_polys(&a, 1);
+}
+
+/*************************************************
+* Name:        ntt32x2_avx
+*
+* Description: Forward NTT of two polynomials, see ntt32_avx.
+*
+* Arguments:   - uint32_t a0[N]: first input/output coefficient array
+*              - uint32_t a1[N]: second input/output coefficient array
+**************************************************/
+void ntt32x2_avx(uint32_t a0[N], uint32_t a1[N]) {
+  uint32_t *a[2] = {a0, a1};
+
+  ntt_polys(a, 2);
+}
+
+/*************************************************
+* Name:        ntt32x4_avx
+*
+* Description: Forward NTT of four polynomials, see ntt32_avx.
+*
+* Arguments:   - uint32_t a0[N]: first input/output coefficient array
+*              - uint32_t a1[N]: second input/output coefficient array
+*              - uint32_t a2[N]: third input/output coefficient array
+*              - uint32_t a3[N]: fourth input/output coefficient array
+**************************************************/
+void ntt32x4_avx(uint32_t a0[N], uint32_t a1[N], uint32_t a2[N],
+                 uint32_t a3[N])
+{
+  uint32_t *a[4] = {a0, a1, a2, a3};
+
+  ntt_polys(a, 4);
+}
+
+/*************************************************
+* Name:        invntt32_avx
+*
+* Description: Inverse NTT and multiplication by Montgomery factor 2^32,
+*              in-place. Same output as the reference implementation. Input
+*              coefficients need to be less than 2*Q. Output coefficients
+*              are less than 2*Q.
+*
+* Arguments:   - uint32_t a[N]: input/output coefficient array
+*                               (32-byte aligned)
+**************************************************/
+void invntt32_avx(uint32_t a[N]) {
+  invntt_polys(&a, 1);
+}
+
+/*************************************************
+* Name:        invntt32x2_avx
+*
+* Description: Inverse NTT of two polynomials, see invntt32_avx.
+*
+* Arguments:   - uint32_t a0[N]: first input/output coefficient array
+*              - uint32_t a1[N]: second input/output coefficient array
+**************************************************/
+void invntt32x2_avx(uint32_t a0[N], uint32_t a1[N]) {
+  uint32_t *a[2] = {a0, a1};
+
+  invntt_polys(a, 2);
+}
+
+/*************************************************
+* Name:        invntt32x4_avx
+*
+* Description: Inverse NTT of four polynomials, see invntt32_avx.
+*
+* Arguments:   - uint32_t a0[N]: first input/output coefficient array
+*              - uint32_t a1[N]: second input/output coefficient array
+*              - uint32_t a2[N]: third input/output coefficient array
+*              - uint32_t a3[N]: fourth input/output coefficient array
+**************************************************/
+void invntt32x4_avx(uint32_t a0[N], uint32_t a1[N], uint32_t a2[N],
+                    uint32_t a3[N])
+{
+  uint32_t *a[4] = {a0, a1, a2, a3};
+
+  invntt_polys(a, 4);
+}
@@ -24,6 +24,156 @@ const uint32_t _8xdiv[8] __attribute__((aligned(32))) = {DIV, DIV, DIV, DIV, DIV
 #undef MONT
 #undef DIV
 
-const uint32_t zetas[N] __attribute__((aligned(32))) = {0, 25847, 5771523, 7861508, 237124, 7602457, 7504169, 466468, 1826347, 2725464, 1024112, 2706023, 95776, 3077325, 3530437, 4450022, 4702672, 6927966, 2176455, 6851714, 5339162, 3475950, 6795196, 2091667, 5037939, 266997, 4860065, 3407706, 2244091, 2434439, 4621053, 2316500, 5933984, 7144689, 7183191, 3817976, 4817955, 3513181, 5187039, 2353451, 7300517, 3585928, 6718724, 4788269, 5842901, 3915439, 7122806, 4296819, 5190273, 4747489, 1939314, 7380215, 5223087, 126922, 900702, 495491, 7725090, 4823422, 1859098, 6767243, 5257975, 7855319, 909542, 8337157, 2031748, 7611795, 819034, 7857917, 3207046, 4784579, 8021166, 7830929, 7260833, 4519302, 5336701, 3574422, 5512770, 3412210, 2147896, 5412772, 7969390, 7396998, 2715295, 4686924, 5903370, 342297, 3437287, 2842341, 4055324, 286988, 5038140, 2691481, 1247620, 5942594, 1735879, 5790267, 2486353, 4108315, 203044, 1265009, 1595974, 6288512, 2619752, 6271868, 3539968, 8079950, 2348700, 7841118, 7709315, 8357436, 7998430, 1852771, 7151892, 7072248, 1349076, 6949987, 4613401, 5386378, 7047359, 7929317, 1250494, 1869119, 1237275, 1312455, 2635921, 1903435, 5062207, 3306115, 4832145, 7329447, 6950192, 6417775, 3119733, 6262231, 4520680, 6681150, 6736599, 3505694, 4558682, 5037034, 508951, 44288, 904516, 264944, 3097992, 7280319, 3958618, 7100756, 1500165, 7838005, 5796124, 1917081, 777191, 5548557, 4656147, 5834105, 2235880, 6709241, 594136, 7005614, 3406031, 6533464, 4603424, 5495562, 6980856, 5102745, 3507263, 6239768, 6779997, 3699596, 4656075, 1653064, 2389356, 759969, 8371839, 5130689, 8169440, 7063561, 6366809, 1957272, 5196991, 810149, 2432395, 3369112, 162844, 1652634, 2454455, 185531, 1616392, 4686184, 8215696, 7173032, 3014001, 6581310, 3111497, 1757237, 8360995, 811944, 531354, 954230, 3881043, 189548, 3159746, 5971092, 1315589, 4827145, 6529015, 8202977, 1341330, 5341501, 2213111, 7953734, 6712985, 3523897, 7404533, 1723600, 7276084, 3866901, 1717735, 6577327, 8119771, 269760, 472078, 1910376, 4546524, 2680103, 4010497, 280005, 3900724, 5823537, 2071892, 5582638, 1285669, 7567685, 5361315, 4751448, 6795489, 6940675, 4499357, 3839961, 5441381, 183443, 7826001, 3937738, 6144432, 7403526, 3919660, 1400424, 7959518, 1612842, 8332111, 7534263, 6094090, 4834730, 7018208, 1976782};
+/* Roots of unity in the order and lane layout of ntt32_avx: zetas 0 to 63 of
+ * the reference implementation followed by one vector per 8 coefficients
+ * for each of the last two levels */
+const uint32_t zetas_ntt32[576] __attribute__((aligned(32))) = {
+  0, 25847, 5771523, 7861508, 237124, 7602457, 7504169, 466468, 1826347,
+  2353451, 8021166, 6288512, 3119733, 5495562, 3111497, 2680103, 2725464,
+  1024112, 7300517, 3585928, 7830929, 7260833, 2619752, 6271868, 6262231,
+  4520680, 6980856, 5102745, 1757237, 8360995, 4010497, 280005, 2706023, 95776,
+  3077325, 3530437, 6718724, 4788269, 5842901, 3915439, 4519302, 5336701,
+  3574422, 5512770, 3539968, 8079950, 2348700, 7841118, 6681150, 6736599,
+  3505694, 4558682, 3507263, 6239768, 6779997, 3699596, 811944, 531354, 954230,
+  3881043, 3900724, 5823537, 2071892, 5582638, 4450022, 4450022, 4450022,
+  4450022, 6851714, 6851714, 6851714, 6851714, 4702672, 4702672, 4702672,
+  4702672, 5339162, 5339162, 5339162, 5339162, 6927966, 6927966, 6927966,
+  6927966, 3475950, 3475950, 3475950, 3475950, 2176455, 2176455, 2176455,
+  2176455, 6795196, 6795196, 6795196, 6795196, 7122806, 7122806, 7122806,
+  7122806, 1939314, 1939314, 1939314, 1939314, 4296819, 4296819, 4296819,
+  4296819, 7380215, 7380215, 7380215, 7380215, 5190273, 5190273, 5190273,
+  5190273, 5223087, 5223087, 5223087, 5223087, 4747489, 4747489, 4747489,
+  4747489, 126922, 126922, 126922, 126922, 3412210, 3412210, 3412210, 3412210,
+  7396998, 7396998, 7396998, 7396998, 2147896, 2147896, 2147896, 2147896,
+  2715295, 2715295, 2715295, 2715295, 5412772, 5412772, 5412772, 5412772,
+  4686924, 4686924, 4686924, 4686924, 7969390, 7969390, 7969390, 7969390,
+  5903370, 5903370, 5903370, 5903370, 7709315, 7709315, 7709315, 7709315,
+  7151892, 7151892, 7151892, 7151892, 8357436, 8357436, 8357436, 8357436,
+  7072248, 7072248, 7072248, 7072248, 7998430, 7998430, 7998430, 7998430,
+  1349076, 1349076, 1349076, 1349076, 1852771, 1852771, 1852771, 1852771,
+  6949987, 6949987, 6949987, 6949987, 5037034, 5037034, 5037034, 5037034,
+  264944, 264944, 264944, 264944, 508951, 508951, 508951, 508951, 3097992,
+  3097992, 3097992, 3097992, 44288, 44288, 44288, 44288, 7280319, 7280319,
+  7280319, 7280319, 904516, 904516, 904516, 904516, 3958618, 3958618, 3958618,
+  3958618, 4656075, 4656075, 4656075, 4656075, 8371839, 8371839, 8371839,
+  8371839, 1653064, 1653064, 1653064, 1653064, 5130689, 5130689, 5130689,
+  5130689, 2389356, 2389356, 2389356, 2389356, 8169440, 8169440, 8169440,
+  8169440, 759969, 759969, 759969, 759969, 7063561, 7063561, 7063561, 7063561,
+  189548, 189548, 189548, 189548, 4827145, 4827145, 4827145, 4827145, 3159746,
+  3159746, 3159746, 3159746, 6529015, 6529015, 6529015, 6529015, 5971092,
+  5971092, 5971092, 5971092, 8202977, 8202977, 8202977, 8202977, 1315589,
+  1315589, 1315589, 1315589, 1341330, 1341330, 1341330, 1341330, 1285669,
+  1285669, 1285669, 1285669, 6795489, 6795489, 6795489, 6795489, 7567685,
+  7567685, 7567685, 7567685, 6940675, 6940675, 6940675, 6940675, 5361315,
+  5361315, 5361315, 5361315, 4499357, 4499357, 4499357, 4499357, 4751448,
+  4751448, 4751448, 4751448, 3839961, 3839961, 3839961, 3839961, 2091667,
+  2091667, 3407706, 3407706, 2316500, 2316500, 3817976, 3817976, 5037939,
+  5037939, 2244091, 2244091, 5933984, 5933984, 4817955, 4817955, 266997,
+  266997, 2434439, 2434439, 7144689, 7144689, 3513181, 3513181, 4860065,
+  4860065, 4621053, 4621053, 7183191, 7183191, 5187039, 5187039, 900702,
+  900702, 1859098, 1859098, 909542, 909542, 819034, 819034, 495491, 495491,
+  6767243, 6767243, 8337157, 8337157, 7857917, 7857917, 7725090, 7725090,
+  5257975, 5257975, 2031748, 2031748, 3207046, 3207046, 4823422, 4823422,
+  7855319, 7855319, 7611795, 7611795, 4784579, 4784579, 342297, 342297, 286988,
+  286988, 5942594, 5942594, 4108315, 4108315, 3437287, 3437287, 5038140,
+  5038140, 1735879, 1735879, 203044, 203044, 2842341, 2842341, 2691481,
+  2691481, 5790267, 5790267, 1265009, 1265009, 4055324, 4055324, 1247620,
+  1247620, 2486353, 2486353, 1595974, 1595974, 4613401, 4613401, 1250494,
+  1250494, 2635921, 2635921, 4832145, 4832145, 5386378, 5386378, 1869119,
+  1869119, 1903435, 1903435, 7329447, 7329447, 7047359, 7047359, 1237275,
+  1237275, 5062207, 5062207, 6950192, 6950192, 7929317, 7929317, 1312455,
+  1312455, 3306115, 3306115, 6417775, 6417775, 7100756, 7100756, 1917081,
+  1917081, 5834105, 5834105, 7005614, 7005614, 1500165, 1500165, 777191,
+  777191, 2235880, 2235880, 3406031, 3406031, 7838005, 7838005, 5548557,
+  5548557, 6709241, 6709241, 6533464, 6533464, 5796124, 5796124, 4656147,
+  4656147, 594136, 594136, 4603424, 4603424, 6366809, 6366809, 2432395,
+  2432395, 2454455, 2454455, 8215696, 8215696, 1957272, 1957272, 3369112,
+  3369112, 185531, 185531, 7173032, 7173032, 5196991, 5196991, 162844, 162844,
+  1616392, 1616392, 3014001, 3014001, 810149, 810149, 1652634, 1652634,
+  4686184, 4686184, 6581310, 6581310, 5341501, 5341501, 3523897, 3523897,
+  3866901, 3866901, 269760, 269760, 2213111, 2213111, 7404533, 7404533,
+  1717735, 1717735, 472078, 472078, 7953734, 7953734, 1723600, 1723600,
+  6577327, 6577327, 1910376, 1910376, 6712985, 6712985, 7276084, 7276084,
+  8119771, 8119771, 4546524, 4546524, 5441381, 5441381, 6144432, 6144432,
+  7959518, 7959518, 6094090, 6094090, 183443, 183443, 7403526, 7403526,
+  1612842, 1612842, 4834730, 4834730, 7826001, 7826001, 3919660, 3919660,
+  8332111, 8332111, 7018208, 7018208, 3937738, 3937738, 1400424, 1400424,
+  7534263, 7534263, 1976782, 1976782
+};
 
-const uint32_t zetas_inv[N] __attribute__((aligned(32))) = {6403635, 1362209, 3545687, 2286327, 846154, 48306, 6767575, 420899, 6979993, 4460757, 976891, 2235985, 4442679, 554416, 8196974, 2939036, 4540456, 3881060, 1439742, 1584928, 3628969, 3019102, 812732, 7094748, 2797779, 6308525, 2556880, 4479693, 8100412, 4369920, 5700314, 3833893, 6470041, 7908339, 8110657, 260646, 1803090, 6662682, 4513516, 1104333, 6656817, 975884, 4856520, 1667432, 426683, 6167306, 3038916, 7039087, 177440, 1851402, 3553272, 7064828, 2409325, 5220671, 8190869, 4499374, 7426187, 7849063, 7568473, 19422, 6623180, 5268920, 1799107, 5366416, 1207385, 164721, 3694233, 6764025, 8194886, 5925962, 6727783, 8217573, 5011305, 5948022, 7570268, 3183426, 6423145, 2013608, 1316856, 210977, 3249728, 8578, 7620448, 5991061, 6727353, 3724342, 4680821, 1600420, 2140649, 4873154, 3277672, 1399561, 2884855, 3776993, 1846953, 4974386, 1374803, 7786281, 1671176, 6144537, 2546312, 3724270, 2831860, 7603226, 6463336, 2584293, 542412, 6880252, 1279661, 4421799, 1100098, 5282425, 8115473, 7475901, 8336129, 7871466, 3343383, 3821735, 4874723, 1643818, 1699267, 3859737, 2118186, 5260684, 1962642, 1430225, 1050970, 3548272, 5074302, 3318210, 6476982, 5744496, 7067962, 7143142, 6511298, 7129923, 451100, 1333058, 2994039, 3767016, 1430430, 7031341, 1308169, 1228525, 6527646, 381987, 22981, 671102, 539299, 6031717, 300467, 4840449, 2108549, 5760665, 2091905, 6784443, 7115408, 8177373, 4272102, 5894064, 2590150, 6644538, 2437823, 7132797, 5688936, 3342277, 8093429, 4325093, 5538076, 4943130, 8038120, 2477047, 3693493, 5665122, 983419, 411027, 2967645, 6232521, 4968207, 2867647, 4805995, 3043716, 3861115, 1119584, 549488, 359251, 3595838, 5173371, 522500, 7561383, 768622, 6348669, 43260, 7470875, 525098, 3122442, 1613174, 6521319, 3556995, 655327, 7884926, 7479715, 8253495, 3157330, 1000202, 6441103, 3632928, 3190144, 4083598, 1257611, 4464978, 2537516, 3592148, 1661693, 4794489, 1079900, 6026966, 3193378, 4867236, 3562462, 4562441, 1197226, 1235728, 2446433, 6063917, 3759364, 5945978, 6136326, 4972711, 3520352, 8113420, 3342478, 6288750, 1585221, 4904467, 3041255, 1528703, 6203962, 1452451, 3677745, 3930395, 4849980, 5303092, 8284641, 5674394, 7356305, 5654953, 6554070, 7913949, 876248, 777960, 8143293, 518909, 2608894, 3975713};
+/* Roots of unity in the order and lane layout of invntt32_avx: one vector
+ * per 8 coefficients for each of the first two levels followed by inverse
+ * zetas 192 to 255 of the reference implementation */
+const uint32_t zetas_inv_ntt32[576] __attribute__((aligned(32))) = {
+  6403635, 6403635, 846154, 846154, 6979993, 6979993, 4442679, 4442679,
+  1362209, 1362209, 48306, 48306, 4460757, 4460757, 554416, 554416, 3545687,
+  3545687, 6767575, 6767575, 976891, 976891, 8196974, 8196974, 2286327,
+  2286327, 420899, 420899, 2235985, 2235985, 2939036, 2939036, 3833893,
+  3833893, 260646, 260646, 1104333, 1104333, 1667432, 1667432, 6470041,
+  6470041, 1803090, 1803090, 6656817, 6656817, 426683, 426683, 7908339,
+  7908339, 6662682, 6662682, 975884, 975884, 6167306, 6167306, 8110657,
+  8110657, 4513516, 4513516, 4856520, 4856520, 3038916, 3038916, 1799107,
+  1799107, 3694233, 3694233, 6727783, 6727783, 7570268, 7570268, 5366416,
+  5366416, 6764025, 6764025, 8217573, 8217573, 3183426, 3183426, 1207385,
+  1207385, 8194886, 8194886, 5011305, 5011305, 6423145, 6423145, 164721,
+  164721, 5925962, 5925962, 5948022, 5948022, 2013608, 2013608, 3776993,
+  3776993, 7786281, 7786281, 3724270, 3724270, 2584293, 2584293, 1846953,
+  1846953, 1671176, 1671176, 2831860, 2831860, 542412, 542412, 4974386,
+  4974386, 6144537, 6144537, 7603226, 7603226, 6880252, 6880252, 1374803,
+  1374803, 2546312, 2546312, 6463336, 6463336, 1279661, 1279661, 1962642,
+  1962642, 5074302, 5074302, 7067962, 7067962, 451100, 451100, 1430225,
+  1430225, 3318210, 3318210, 7143142, 7143142, 1333058, 1333058, 1050970,
+  1050970, 6476982, 6476982, 6511298, 6511298, 2994039, 2994039, 3548272,
+  3548272, 5744496, 5744496, 7129923, 7129923, 3767016, 3767016, 6784443,
+  6784443, 5894064, 5894064, 7132797, 7132797, 4325093, 4325093, 7115408,
+  7115408, 2590150, 2590150, 5688936, 5688936, 5538076, 5538076, 8177373,
+  8177373, 6644538, 6644538, 3342277, 3342277, 4943130, 4943130, 4272102,
+  4272102, 2437823, 2437823, 8093429, 8093429, 8038120, 8038120, 3595838,
+  3595838, 768622, 768622, 525098, 525098, 3556995, 3556995, 5173371, 5173371,
+  6348669, 6348669, 3122442, 3122442, 655327, 655327, 522500, 522500, 43260,
+  43260, 1613174, 1613174, 7884926, 7884926, 7561383, 7561383, 7470875,
+  7470875, 6521319, 6521319, 7479715, 7479715, 3193378, 3193378, 1197226,
+  1197226, 3759364, 3759364, 3520352, 3520352, 4867236, 4867236, 1235728,
+  1235728, 5945978, 5945978, 8113420, 8113420, 3562462, 3562462, 2446433,
+  2446433, 6136326, 6136326, 3342478, 3342478, 4562441, 4562441, 6063917,
+  6063917, 4972711, 4972711, 6288750, 6288750, 4540456, 4540456, 4540456,
+  4540456, 3628969, 3628969, 3628969, 3628969, 3881060, 3881060, 3881060,
+  3881060, 3019102, 3019102, 3019102, 3019102, 1439742, 1439742, 1439742,
+  1439742, 812732, 812732, 812732, 812732, 1584928, 1584928, 1584928, 1584928,
+  7094748, 7094748, 7094748, 7094748, 7039087, 7039087, 7039087, 7039087,
+  7064828, 7064828, 7064828, 7064828, 177440, 177440, 177440, 177440, 2409325,
+  2409325, 2409325, 2409325, 1851402, 1851402, 1851402, 1851402, 5220671,
+  5220671, 5220671, 5220671, 3553272, 3553272, 3553272, 3553272, 8190869,
+  8190869, 8190869, 8190869, 1316856, 1316856, 1316856, 1316856, 7620448,
+  7620448, 7620448, 7620448, 210977, 210977, 210977, 210977, 5991061, 5991061,
+  5991061, 5991061, 3249728, 3249728, 3249728, 3249728, 6727353, 6727353,
+  6727353, 6727353, 8578, 8578, 8578, 8578, 3724342, 3724342, 3724342, 3724342,
+  4421799, 4421799, 4421799, 4421799, 7475901, 7475901, 7475901, 7475901,
+  1100098, 1100098, 1100098, 1100098, 8336129, 8336129, 8336129, 8336129,
+  5282425, 5282425, 5282425, 5282425, 7871466, 7871466, 7871466, 7871466,
+  8115473, 8115473, 8115473, 8115473, 3343383, 3343383, 3343383, 3343383,
+  1430430, 1430430, 1430430, 1430430, 6527646, 6527646, 6527646, 6527646,
+  7031341, 7031341, 7031341, 7031341, 381987, 381987, 381987, 381987, 1308169,
+  1308169, 1308169, 1308169, 22981, 22981, 22981, 22981, 1228525, 1228525,
+  1228525, 1228525, 671102, 671102, 671102, 671102, 2477047, 2477047, 2477047,
+  2477047, 411027, 411027, 411027, 411027, 3693493, 3693493, 3693493, 3693493,
+  2967645, 2967645, 2967645, 2967645, 5665122, 5665122, 5665122, 5665122,
+  6232521, 6232521, 6232521, 6232521, 983419, 983419, 983419, 983419, 4968207,
+  4968207, 4968207, 4968207, 8253495, 8253495, 8253495, 8253495, 3632928,
+  3632928, 3632928, 3632928, 3157330, 3157330, 3157330, 3157330, 3190144,
+  3190144, 3190144, 3190144, 1000202, 1000202, 1000202, 1000202, 4083598,
+  4083598, 4083598, 4083598, 6441103, 6441103, 6441103, 6441103, 1257611,
+  1257611, 1257611, 1257611, 1585221, 1585221, 1585221, 1585221, 6203962,
+  6203962, 6203962, 6203962, 4904467, 4904467, 4904467, 4904467, 1452451,
+  1452451, 1452451, 1452451, 3041255, 3041255, 3041255, 3041255, 3677745,
+  3677745, 3677745, 3677745, 1528703, 1528703, 1528703, 1528703, 3930395,
+  3930395, 3930395, 3930395, 2797779, 6308525, 2556880, 4479693, 4499374,
+  7426187, 7849063, 7568473, 4680821, 1600420, 2140649, 4873154, 3821735,
+  4874723, 1643818, 1699267, 539299, 6031717, 300467, 4840449, 2867647,
+  4805995, 3043716, 3861115, 4464978, 2537516, 3592148, 1661693, 4849980,
+  5303092, 8284641, 5674394, 8100412, 4369920, 19422, 6623180, 3277672,
+  1399561, 3859737, 2118186, 2108549, 5760665, 1119584, 549488, 4794489,
+  1079900, 7356305, 5654953, 5700314, 5268920, 2884855, 5260684, 2091905,
+  359251, 6026966, 6554070, 7913949, 876248, 777960, 8143293, 518909, 2608894,
+  8354570, 0
+};
@@ -149,14 +149,43 @@ void poly_shiftl(poly *a) {
 * Arguments:   - poly *a: pointer to input/output polynomial
 **************************************************/
 void poly_ntt(poly *a) {
-  unsigned int i;
-  uint64_t __attribute__((aligned(32))) tmp[N];
   DBENCH_START();
 
-  for(i = 0; i < N/32; ++i)
-    ntt_levels0t2_avx(tmp + 4*i, a->coeffs + 4*i, zetas + 1);
-  for(i = 0; i < N/32; ++i)
-    ntt_levels3t8_avx(a->coeffs + 32*i, tmp + 32*i, zetas + 8 + 31*i);
+  ntt32_avx(a->coeffs);
+
+  DBENCH_STOP(*tmul);
+}
+
+/*************************************************
+* Name:        poly_ntt_2x
+*
+* Description: Forward NTT of two polynomials at once, see poly_ntt.
+*
+* Arguments:   - poly *a0: pointer to first input/output polynomial
+*              - poly *a1: pointer to second input/output polynomial
+**************************************************/
+void poly_ntt_2x(poly *a0, poly *a1) {
+  DBENCH_START();
+
+  ntt32x2_avx(a0->coeffs, a1->coeffs);
+
+  DBENCH_STOP(*tmul);
+}
+
+/*************************************************
+* Name:        poly_ntt_4x
+*
+* Description: Forward NTT of four polynomials at once, see poly_ntt.
+*
+* Arguments:   - poly *a0: pointer to first input/output polynomial
+*              - poly *a1: pointer to second input/output polynomial
+*              - poly *a2: pointer to third input/output polynomial
+*              - poly *a3: pointer to fourth input/output polynomial
+**************************************************/
+void poly_ntt_4x(poly *a0, poly *a1, poly *a2, poly *a3) {
+  DBENCH_START();
+
+  ntt32x4_avx(a0->coeffs, a1->coeffs, a2->coeffs, a3->coeffs);
 
   DBENCH_STOP(*tmul);
 }
@@ -170,14 +199,45 @@ void poly_ntt(poly *a) {
 * Arguments:   - poly *a: pointer to input/output polynomial
 **************************************************/
 void poly_invntt_montgomery(poly *a) {
-  unsigned int i;
-  uint64_t __attribute__((aligned(32))) tmp[N];
   DBENCH_START();
 
-  for(i = 0; i < N/32; i++)
-    invntt_levels0t4_avx(tmp + 32*i, a->coeffs + 32*i, zetas_inv + 31*i);
-  for(i = 0; i < N/32; i++)
-    invntt_levels5t7_avx(a->coeffs + 4*i, tmp + 4*i, zetas_inv + 248);
+  invntt32_avx(a->coeffs);
+
+  DBENCH_STOP(*tmul);
+}
+
+/*************************************************
+* Name:        poly_invntt_montgomery_2x
+*
+* Description: Inverse NTT and multiplication with 2^{32} of two polynomials
+*              at once, see poly_invntt_montgomery.
+*
+* Arguments:   - poly *a0: pointer to first input/output polynomial
+*              - poly *a1: pointer to second input/output polynomial
+**************************************************/
+void poly_invntt_montgomery_2x(poly *a0, poly *a1) {
+  DBENCH_START();
+
+  invntt32x2_avx(a0->coeffs, a1->coeffs);
+
+  DBENCH_STOP(*tmul);
+}
+
+/*************************************************
+* Name:        poly_invntt_montgomery_4x
+*
+* Description: Inverse NTT and multiplication with 2^{32} of four
+*              polynomials at once, see poly_invntt_montgomery.
+*
+* Arguments:   - poly *a0: pointer to first input/output polynomial
+*              - poly *a1: pointer to second input/output polynomial
+*              - poly *a2: pointer to third input/output polynomial
+*              - poly *a3: pointer to fourth input/output polynomial
+**************************************************/
+void poly_invntt_montgomery_4x(poly *a0, poly *a1, poly *a2, poly *a3) {
+  DBENCH_START();
+
+  invntt32x4_avx(a0->coeffs, a1->coeffs, a2->coeffs, a3->coeffs);
 
   DBENCH_STOP(*tmul);
 }
@@ -202,6 +262,40 @@ void poly_pointwise_invmontgomery(poly *c, const poly *a, const poly *b) {
   DBENCH_STOP(*tmul);
 }
 
+/*************************************************
+* Name:        poly_prepare
+*
+* Description: Prepare polynomial in NTT domain as fixed operand of
+*              poly_pointwise_prepared. The input may alias r->w.
+*
+* Arguments:   - poly_prepared *r: pointer to output prepared polynomial
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_prepare(poly_prepared *r, const poly *a) {
+  if(&r->w != a)
+    r->w = *a;
+}
+
+/*************************************************
+* Name:        poly_pointwise_prepared
+*
+* Description: Pointwise multiplication of polynomial in NTT domain with
+*              prepared polynomial and multiplication of resulting
+*              polynomial with 2^{-32}. Output coefficients are less than
+*              2*Q if input coefficients are less than 22*Q.
+*
+* Arguments:   - poly *c: pointer to output polynomial
+*              - const poly *a: pointer to input polynomial
+*              - const poly_prepared *b: pointer to prepared polynomial
+**************************************************/
+void poly_pointwise_prepared(poly *c, const poly *a, const poly_prepared *b) {
+  DBENCH_START();
+
+  pointwise_avx(c->coeffs, a->coeffs, b->w.coeffs);
+
+  DBENCH_STOP(*tmul);
+}
+
 /*************************************************
 * Name:        poly_power2round
 *
@@ -415,7 +509,127 @@ void poly_uniform(poly *a,
   }
 }
 
-#ifndef USE_AES
+#ifdef USE_AES
+/*************************************************
+* Name:        poly_uniform_aes4x
+*
+* Description: Sample four polynomials from four AES-256-CTR streams that
+*              share the key seed and differ in the nonce, with one key
+*              schedule and the counter blocks of all four streams in one
+*              pipeline. Every stream is sampled as a contiguous byte
+*              stream like in the single-polynomial functions: nblocks
+*              blocks at first, then one block at a time with the bytes of
+*              an incomplete candidate carried over.
+*
+* Arguments:   - poly *a[4]: pointers to output polynomials
+*              - const unsigned char *seed: byte array with 32-byte key
+*              - const uint16_t nonce[4]: nonces of the four streams
+*              - unsigned int nblocks: number of blocks sampled at first
+*              - unsigned int grp: number of bytes per group of candidates
+*              - rej: rejection sampler for the byte stream
+**************************************************/
+static void poly_uniform_aes4x(poly *a[4],
+                               const unsigned char *seed,
+                               const uint16_t nonce[4],
+                               unsigned int nblocks,
+                               unsigned int grp,
+                               unsigned int (*rej)(uint32_t *,
+                                                   unsigned int,
+                                                   const unsigned char *,
+                                                   unsigned int))
+{
+  unsigned int i, j, off, ctr[4];
+  unsigned int buflen = nblocks*STREAM128_BLOCKBYTES;
+  unsigned char buf[4][buflen + 4];
+  aes256ctr4x_ctx state;
+
+  aes256ctr4x_init(&state, seed, nonce[0], nonce[1], nonce[2], nonce[3]);
+  aes256ctr4x_squeezeblocks(buf[0], buf[1], buf[2], buf[3], nblocks, &state);
+
+  for(j = 0; j < 4; ++j)
+    ctr[j] = rej(a[j]->coeffs, N, buf[j], buflen);
+
+  while(ctr[0] < N || ctr[1] < N || ctr[2] < N || ctr[3] < N) {
+    off = buflen % grp;
+    for(j = 0; j < 4; ++j)
+      for(i = 0; i < off; ++i)
+        buf[j][i] = buf[j][buflen - off + i];
+
+    buflen = STREAM128_BLOCKBYTES + off;
+    aes256ctr4x_squeezeblocks(buf[0] + off, buf[1] + off, buf[2] + off,
+                              buf[3] + off, 1, &state);
+
+    for(j = 0; j < 4; ++j)
+      if(ctr[j] < N)
+        ctr[j] += rej(a[j]->coeffs + ctr[j], N - ctr[j], buf[j], buflen);
+  }
+}
+
+void poly_uniform_4x(poly *a0,
+                     poly *a1,
+                     poly *a2,
+                     poly *a3,
+                     const unsigned char seed[SEEDBYTES],
+                     uint16_t nonce0,
+                     uint16_t nonce1,
+                     uint16_t nonce2,
+                     uint16_t nonce3)
+{
+  poly *a[4] = {a0, a1, a2, a3};
+  const uint16_t nonce[4] = {nonce0, nonce1, nonce2, nonce3};
+
+  poly_uniform_aes4x(a, seed, nonce,
+                     (769 + STREAM128_BLOCKBYTES)/STREAM128_BLOCKBYTES, 3,
+                     rej_uniform);
+}
+
+/*************************************************
+* Name:        poly_sample_jobs
+*
+* Description: Run a list of sampling jobs on four AES-256-CTR streams.
+*              Runs of up to four consecutive jobs with the same seed
+*              pointer and type share one key schedule and are sampled
+*              as with poly_uniform_4x or poly_uniform_eta_4x; a job
+*              left on its own is sampled by poly_uniform or
+*              poly_uniform_eta. Output is identical to sampling each job
+*              on its own.
+*
+* Arguments:   - const sample_job *jobs: array of n jobs
+*              - unsigned int n: number of jobs
+**************************************************/
+void poly_sample_jobs(const sample_job *jobs, unsigned int n)
+{
+  unsigned int i, j, k;
+  uint16_t nonce[4];
+  poly *a[4], tmp[2];
+
+  for(i = 0; i < n; i += k) {
+    for(k = 1; k < 4 && i + k < n; ++k)
+      if(jobs[i+k].seed != jobs[i].seed || jobs[i+k].type != jobs[i].type)
+        break;
+
+    if(k == 1) {
+      if(jobs[i].type == SAMPLE_UNIFORM)
+        poly_uniform(jobs[i].a, jobs[i].seed, jobs[i].nonce);
+      else
+        poly_uniform_eta(jobs[i].a, jobs[i].seed, jobs[i].nonce);
+      continue;
+    }
+
+    for(j = 0; j < 4; ++j) {
+      a[j] = (j < k) ? jobs[i+j].a : &tmp[j - k];
+      nonce[j] = (j < k) ? jobs[i+j].nonce : 0;
+    }
+
+    if(jobs[i].type == SAMPLE_UNIFORM)
+      poly_uniform_4x(a[0], a[1], a[2], a[3], jobs[i].seed,
+                      nonce[0], nonce[1], nonce[2], nonce[3]);
+    else
+      poly_uniform_eta_4x(a[0], a[1], a[2], a[3], jobs[i].seed,
+                          nonce[0], nonce[1], nonce[2], nonce[3]);
+  }
+}
+#else
 void poly_uniform_4x(poly *a0,
                      poly *a1,
                      poly *a2,
@@ -426,9 +640,9 @@ void poly_uniform_4x(poly *a0,
                      uint16_t nonce2,
                      uint16_t nonce3)
 {
-  unsigned int i, ctr0, ctr1, ctr2, ctr3;
+  unsigned int i, ctr[4];
   unsigned char inbuf[4][SEEDBYTES + 2];
-  unsigned char outbuf[4][5*SHAKE128_RATE];
+  uint32_t *r[4] = {a0->coeffs, a1->coeffs, a2->coeffs, a3->coeffs};
   __m256i state[25];
 
   for(i= 0; i < SEEDBYTES; ++i) {
@@ -448,26 +662,107 @@ void poly_uniform_4x(poly *a0,
 
   shake128_absorb4x(state, inbuf[0], inbuf[1], inbuf[2], inbuf[3],
                     SEEDBYTES + 2);
-  shake128_squeezeblocks4x(outbuf[0], outbuf[1], outbuf[2], outbuf[3], 5,
-                           state);
 
-  ctr0 = rej_uniform(a0->coeffs, N, outbuf[0], 5*SHAKE128_RATE);
-  ctr1 = rej_uniform(a1->coeffs, N, outbuf[1], 5*SHAKE128_RATE);
-  ctr2 = rej_uniform(a2->coeffs, N, outbuf[2], 5*SHAKE128_RATE);
-  ctr3 = rej_uniform(a3->coeffs, N, outbuf[3], 5*SHAKE128_RATE);
+  /* Sample straight from the state; SHAKE128_RATE is a multiple of the
+     24 bytes per 8 candidates, so every block is used up */
+  ctr[0] = ctr[1] = ctr[2] = ctr[3] = 0;
+  while(ctr[0] < N || ctr[1] < N || ctr[2] < N || ctr[3] < N) {
+    keccak_permute4x(state);
+    rej_uniform_4x(r, ctr, N, state, SHAKE128_RATE/8);
+  }
+}
 
-  while(ctr0 < N || ctr1 < N || ctr2 < N || ctr3 < N) {
-    shake128_squeezeblocks4x(outbuf[0], outbuf[1], outbuf[2], outbuf[3], 1,
-                             state);
+/*************************************************
+* Name:        sample_job_start
+*
+* Description: Start a sampling job in one lane of a 4-way SHAKE128 state
+*              by absorbing its seed|nonce into that lane only. The first
+*              block of the job comes out of the next permutation.
+*
+* Arguments:   - __m256i *state: pointer to 4-way Keccak state
+*              - unsigned int j: lane index
+*              - const sample_job *job: pointer to job
+**************************************************/
+static void sample_job_start(__m256i state[25],
+                             unsigned int j,
+                             const sample_job *job)
+{
+  unsigned int i;
+  unsigned char inbuf[SEEDBYTES + 2];
+
+  for(i = 0; i < SEEDBYTES; ++i)
+    inbuf[i] = job->seed[i];
+  inbuf[SEEDBYTES+0] = job->nonce;
+  inbuf[SEEDBYTES+1] = job->nonce >> 8;
+
+  shake128_absorb_lane4x(state, j, inbuf, SEEDBYTES + 2);
+}
+
+/*************************************************
+* Name:        poly_sample_jobs
+*
+* Description: Run a list of sampling jobs on the lanes of a 4-way
+*              SHAKE128 state. Job i samples *jobs[i].a from
+*              SHAKE128(jobs[i].seed|jobs[i].nonce), uniformly in [0,Q-1]
+*              for SAMPLE_UNIFORM as poly_uniform does, or in [-ETA,ETA]
+*              for SAMPLE_ETA as poly_uniform_eta does. A lane whose job
+*              is done takes the next job right away, so lanes only idle
+*              at the end of the list, whatever its length. Output is
+*              identical to sampling each job on its own.
+*
+* Arguments:   - const sample_job *jobs: array of n jobs
+*              - unsigned int n: number of jobs
+**************************************************/
+void poly_sample_jobs(const sample_job *jobs, unsigned int n)
+{
+  unsigned int i, j, next, ctr[4], cu[4], ce[4];
+  int nu, ne;
+  const sample_job *job[4];
+  uint32_t *r[4];
+  __m256i state[25];
 
-    ctr0 += rej_uniform_ref(a0->coeffs + ctr0, N - ctr0, outbuf[0],
-                            SHAKE128_RATE);
-    ctr1 += rej_uniform_ref(a1->coeffs + ctr1, N - ctr1, outbuf[1],
-                            SHAKE128_RATE);
-    ctr2 += rej_uniform_ref(a2->coeffs + ctr2, N - ctr2, outbuf[2],
-                            SHAKE128_RATE);
-    ctr3 += rej_uniform_ref(a3->coeffs + ctr3, N - ctr3, outbuf[3],
-                            SHAKE128_RATE);
+  for(i = 0; i < 25; ++i)
+    state[i] = _mm256_setzero_si256();
+
+  next = 0;
+  for(j = 0; j < 4; ++j) {
+    job[j] = (next < n) ? &jobs[next++] : NULL;
+    if(job[j]) {
+      sample_job_start(state, j, job[j]);
+      r[j] = job[j]->a->coeffs;
+    }
+    ctr[j] = 0;
+  }
+
+  while(job[0] || job[1] || job[2] || job[3]) {
+    keccak_permute4x(state);
+
+    nu = ne = 0;
+    for(j = 0; j < 4; ++j) {
+      cu[j] = (job[j] && job[j]->type == SAMPLE_UNIFORM) ? ctr[j] : N;
+      ce[j] = (job[j] && job[j]->type == SAMPLE_ETA) ? ctr[j] : N;
+      nu |= cu[j] < N;
+      ne |= ce[j] < N;
+    }
+    if(nu)
+      rej_uniform_4x(r, cu, N, state, SHAKE128_RATE/8);
+    if(ne)
+      rej_eta_4x(r, ce, N, state, SHAKE128_RATE/8);
+
+    for(j = 0; j < 4; ++j) {
+      if(!job[j])
+        continue;
+      ctr[j] = (job[j]->type == SAMPLE_UNIFORM) ? cu[j] : ce[j];
+      if(ctr[j] < N)
+        continue;
+
+      job[j] = (next < n) ? &jobs[next++] : NULL;
+      if(job[j]) {
+        sample_job_start(state, j, job[j]);
+        r[j] = job[j]->a->coeffs;
+        ctr[j] = 0;
+      }
+    }
   }
 }
 #endif
@@ -552,7 +847,7 @@ void poly_uniform_eta(poly *a,
   }
 }
 
-#ifndef USE_AES
+#ifdef USE_AES
 void poly_uniform_eta_4x(poly *a0,
                          poly *a1,
                          poly *a2,
@@ -563,9 +858,28 @@ void poly_uniform_eta_4x(poly *a0,
                          uint16_t nonce2,
                          uint16_t nonce3)
 {
-  unsigned int i, ctr0, ctr1, ctr2, ctr3;
+  poly *a[4] = {a0, a1, a2, a3};
+  const uint16_t nonce[4] = {nonce0, nonce1, nonce2, nonce3};
+
+  poly_uniform_aes4x(a, seed, nonce,
+                     ((N/2 * (1U << SETABITS)) / (2*ETA + 1)
+                      + STREAM128_BLOCKBYTES) / STREAM128_BLOCKBYTES, 1,
+                     rej_eta);
+}
+#else
+void poly_uniform_eta_4x(poly *a0,
+                         poly *a1,
+                         poly *a2,
+                         poly *a3,
+                         const unsigned char seed[SEEDBYTES],
+                         uint16_t nonce0,
+                         uint16_t nonce1,
+                         uint16_t nonce2,
+                         uint16_t nonce3)
+{
+  unsigned int i, ctr[4];
   unsigned char inbuf[4][SEEDBYTES + 2];
-  unsigned char outbuf[4][2*SHAKE128_RATE];
+  uint32_t *r[4] = {a0->coeffs, a1->coeffs, a2->coeffs, a3->coeffs};
   __m256i state[25];
 
   for(i= 0; i < SEEDBYTES; ++i) {
@@ -585,22 +899,12 @@ void poly_uniform_eta_4x(poly *a0,
 
   shake128_absorb4x(state, inbuf[0], inbuf[1], inbuf[2], inbuf[3],
                     SEEDBYTES + 2);
-  shake128_squeezeblocks4x(outbuf[0], outbuf[1], outbuf[2], outbuf[3], 2,
-                           state);
-
-  ctr0 = rej_eta(a0->coeffs, N, outbuf[0], 2*SHAKE128_RATE);
-  ctr1 = rej_eta(a1->coeffs, N, outbuf[1], 2*SHAKE128_RATE);
-  ctr2 = rej_eta(a2->coeffs, N, outbuf[2], 2*SHAKE128_RATE);
-  ctr3 = rej_eta(a3->coeffs, N, outbuf[3], 2*SHAKE128_RATE);
-
-  while(ctr0 < N || ctr1 < N || ctr2 < N || ctr3 < N) {
-    shake128_squeezeblocks4x(outbuf[0], outbuf[1], outbuf[2], outbuf[3], 1,
-                             state);
 
-    ctr0 += rej_eta_ref(a0->coeffs + ctr0, N - ctr0, outbuf[0], SHAKE128_RATE);
-    ctr1 += rej_eta_ref(a1->coeffs + ctr1, N - ctr1, outbuf[1], SHAKE128_RATE);
-    ctr2 += rej_eta_ref(a2->coeffs + ctr2, N - ctr2, outbuf[2], SHAKE128_RATE);
-    ctr3 += rej_eta_ref(a3->coeffs + ctr3, N - ctr3, outbuf[3], SHAKE128_RATE);
+  /* Every byte holds two candidates, so every block is used up */
+  ctr[0] = ctr[1] = ctr[2] = ctr[3] = 0;
+  while(ctr[0] < N || ctr[1] < N || ctr[2] < N || ctr[3] < N) {
+    keccak_permute4x(state);
+    rej_eta_4x(r, ctr, N, state, SHAKE128_RATE/8);
   }
 }
 #endif
@@ -693,7 +997,7 @@ void poly_uniform_gamma1m1(poly *a,
   }
 }
 
-#ifndef USE_AES
+#ifdef USE_AES
 void poly_uniform_gamma1m1_4x(poly *a0,
                               poly *a1,
                               poly *a2,
@@ -704,9 +1008,30 @@ void poly_uniform_gamma1m1_4x(poly *a0,
                               uint16_t nonce2,
                               uint16_t nonce3)
 {
-  unsigned int i, ctr0, ctr1, ctr2, ctr3;
+  poly *a[4] = {a0, a1, a2, a3};
+  const uint16_t nonce[4] = {nonce0, nonce1, nonce2, nonce3};
+
+  /* STREAM256_BLOCKBYTES equals STREAM128_BLOCKBYTES with AES */
+  poly_uniform_aes4x(a, seed, nonce,
+                     (641 + STREAM256_BLOCKBYTES) / STREAM256_BLOCKBYTES, 5,
+                     rej_gamma1m1);
+}
+#else
+void poly_uniform_gamma1m1_4x(poly *a0,
+                              poly *a1,
+                              poly *a2,
+                              poly *a3,
+                              const unsigned char seed[CRHBYTES],
+                              uint16_t nonce0,
+                              uint16_t nonce1,
+                              uint16_t nonce2,
+                              uint16_t nonce3)
+{
+  unsigned int i, j, k, nrows, ctr[4];
   unsigned char inbuf[4][CRHBYTES + 2];
-  unsigned char outbuf[4][5*SHAKE256_RATE];
+  unsigned char outbuf[4][SHAKE256_RATE];
+  uint32_t *r[4] = {a0->coeffs, a1->coeffs, a2->coeffs, a3->coeffs};
+  __m256i rows[SHAKE256_RATE/8 + 4];
   __m256i state[25];
 
   for(i = 0; i < CRHBYTES; ++i) {
@@ -726,26 +1051,31 @@ void poly_uniform_gamma1m1_4x(poly *a0,
 
   shake256_absorb4x(state, inbuf[0], inbuf[1], inbuf[2], inbuf[3],
                     CRHBYTES + 2);
-  shake256_squeezeblocks4x(outbuf[0], outbuf[1], outbuf[2], outbuf[3], 5,
-                           state);
 
-  ctr0 = rej_gamma1m1_ref(a0->coeffs, N, outbuf[0], 5*SHAKE256_RATE);
-  ctr1 = rej_gamma1m1_ref(a1->coeffs, N, outbuf[1], 5*SHAKE256_RATE);
-  ctr2 = rej_gamma1m1_ref(a2->coeffs, N, outbuf[2], 5*SHAKE256_RATE);
-  ctr3 = rej_gamma1m1_ref(a3->coeffs, N, outbuf[3], 5*SHAKE256_RATE);
+  /* The first 5 blocks form one stream of 17 groups of 40 bytes; groups
+     straddling two blocks are completed from the rows carried over */
+  ctr[0] = ctr[1] = ctr[2] = ctr[3] = 0;
+  nrows = 0;
+  for(k = 0; k < 5; ++k) {
+    keccak_permute4x(state);
+    for(i = 0; i < SHAKE256_RATE/8; ++i)
+      rows[nrows + i] = state[i];
+    nrows += SHAKE256_RATE/8;
+
+    i = rej_gamma1m1_4x(r, ctr, N, rows, nrows);
+    for(j = i; j < nrows; ++j)
+      rows[j - i] = rows[j];
+    nrows -= i;
+  }
 
-  while(ctr0 < N || ctr1 < N || ctr2 < N || ctr3 < N) {
+  /* Further blocks are sampled on their own, dropping a trailing byte */
+  while(ctr[0] < N || ctr[1] < N || ctr[2] < N || ctr[3] < N) {
     shake256_squeezeblocks4x(outbuf[0], outbuf[1], outbuf[2], outbuf[3], 1,
                              state);
 
-    ctr0 += rej_gamma1m1_ref(a0->coeffs + ctr0, N - ctr0, outbuf[0],
-                            SHAKE256_RATE);
-    ctr1 += rej_gamma1m1_ref(a1->coeffs + ctr1, N - ctr1, outbuf[1],
-                            SHAKE256_RATE);
-    ctr2 += rej_gamma1m1_ref(a2->coeffs + ctr2, N - ctr2, outbuf[2],
-                            SHAKE256_RATE);
-    ctr3 += rej_gamma1m1_ref(a3->coeffs + ctr3, N - ctr3, outbuf[3],
-                            SHAKE256_RATE);
+    for(j = 0; j < 4; ++j)
+      ctr[j] += rej_gamma1m1_ref(r[j] + ctr[j], N - ctr[j], outbuf[j],
+                                 SHAKE256_RATE);
   }
 }
 #endif
@@ -1059,3 +1389,23 @@ void polyw1_pack(unsigned char * restrict r, const poly * restrict a) {
 
   DBENCH_STOP(*tpack);
 }
+
+/*************************************************
+* Name:        polyw1_unpack
+*
+* Description: Unpack polynomial w1 with coefficients in [0, 15].
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const unsigned char *a: byte array with bit-packed polynomial
+**************************************************/
+void polyw1_unpack(poly *r, const unsigned char *a) {
+  unsigned int i;
+  DBENCH_START();
+
+  for(i = 0; i < N/2; ++i) {
+    r->coeffs[2*i+0] = a[i] & 0x0F;
+    r->coeffs[2*i+1] = a[i] >> 4;
+  }
+
+  DBENCH_STOP(*tpack);
+}
@@ -8,6 +8,31 @@ typedef struct {
   uint32_t coeffs[N];
 } poly __attribute__((aligned(32)));
 
+/*
+ * Fixed multiplication operand in NTT domain. Unlike the reference
+ * implementation no Shoup companion is stored, since the vectorized
+ * Montgomery multiplication is faster than Shoup's method with 32-bit lanes.
+ */
+typedef struct {
+  poly w;
+} poly_prepared;
+
+/*
+ * Sampling job for poly_sample_jobs: sample *a from SHAKE128(seed|nonce),
+ * or AES-256-CTR with USE_AES, with coefficients uniform in [0,Q-1]
+ * (SAMPLE_UNIFORM) or in [-ETA,ETA] (SAMPLE_ETA). The seed has SEEDBYTES
+ * bytes.
+ */
+#define SAMPLE_UNIFORM 0
+#define SAMPLE_ETA 1
+
+typedef struct {
+  poly *a;
+  const unsigned char *seed;
+  uint16_t nonce;
+  uint16_t type;
+} sample_job;
+
 void poly_reduce(poly *a);
 void poly_csubq(poly *a);
 void poly_freeze(poly *a);
@@ -17,8 +42,14 @@ void poly_sub(poly *c, const poly *a, const poly *b);
 void poly_shiftl(poly *a);
 
 void poly_ntt(poly *a);
+void poly_ntt_2x(poly *a0, poly *a1);
+void poly_ntt_4x(poly *a0, poly *a1, poly *a2, poly *a3);
 void poly_invntt_montgomery(poly *a);
+void poly_invntt_montgomery_2x(poly *a0, poly *a1);
+void poly_invntt_montgomery_4x(poly *a0, poly *a1, poly *a2, poly *a3);
 void poly_pointwise_invmontgomery(poly *c, const poly *a, const poly *b);
+void poly_prepare(poly_prepared *r, const poly *a);
+void poly_pointwise_prepared(poly *c, const poly *a, const poly_prepared *b);
 
 void poly_power2round(poly *a1, poly *a0, const poly *a);
 void poly_decompose(poly *a1, poly *a0, const poly *a);
@@ -38,6 +69,7 @@ void poly_uniform_4x(poly *a0,
                      uint16_t nonce1,
                      uint16_t nonce2,
                      uint16_t nonce3);
+void poly_sample_jobs(const sample_job *jobs, unsigned int n);
 void poly_uniform_eta(poly *a,
                       const unsigned char seed[SEEDBYTES],
                       uint16_t nonce);
@@ -76,4 +108,5 @@ void polyz_pack(unsigned char *r, const poly *a);
 void polyz_unpack(poly *r, const unsigned char *a);
 
 void polyw1_pack(unsigned char *r, const poly *a);
+void polyw1_unpack(poly *r, const unsigned char *a);
 #endif
@@ -40,6 +40,50 @@ void polyvecl_add(polyvecl *w, const polyvecl *u, const polyvecl *v) {
     poly_add(&w->vec[i], &u->vec[i], &v->vec[i]);
 }
 
+/*************************************************
+* Name:        polyvec_ntt
+*
+* Description: Forward NTT of n polynomials, four or two at a time where
+*              possible.
+*
+* Arguments:   - poly *v: array of n input/output polynomials
+*              - unsigned int n: number of polynomials
+**************************************************/
+static void polyvec_ntt(poly *v, unsigned int n) {
+  unsigned int i;
+
+  for(i = 0; i + 4 <= n; i += 4)
+    poly_ntt_4x(&v[i], &v[i + 1], &v[i + 2], &v[i + 3]);
+  if(i + 2 <= n) {
+    poly_ntt_2x(&v[i], &v[i + 1]);
+    i += 2;
+  }
+  if(i < n)
+    poly_ntt(&v[i]);
+}
+
+/*************************************************
+* Name:        polyvec_invntt_montgomery
+*
+* Description: Inverse NTT and multiplication by 2^{32} of n polynomials,
+*              four or two at a time where possible.
+*
+* Arguments:   - poly *v: array of n input/output polynomials
+*              - unsigned int n: number of polynomials
+**************************************************/
+static void polyvec_invntt_montgomery(poly *v, unsigned int n) {
+  unsigned int i;
+
+  for(i = 0; i + 4 <= n; i += 4)
+    poly_invntt_montgomery_4x(&v[i], &v[i + 1], &v[i + 2], &v[i + 3]);
+  if(i + 2 <= n) {
+    poly_invntt_montgomery_2x(&v[i], &v[i + 1]);
+    i += 2;
+  }
+  if(i < n)
+    poly_invntt_montgomery(&v[i]);
+}
+
 /*************************************************
 * Name:        polyvecl_ntt
 *
@@ -49,10 +93,7 @@ void polyvecl_add(polyvecl *w, const polyvecl *u, const polyvecl *v) {
 * Arguments:   - polyvecl *v: pointer to input/output vector
 **************************************************/
 void polyvecl_ntt(polyvecl *v) {
-  unsigned int i;
-
-  for(i = 0; i < L; ++i)
-    poly_ntt(&v->vec[i]);
+  polyvec_ntt(v->vec, L);
 }
 
 /*************************************************
@@ -75,6 +116,31 @@ void polyvecl_pointwise_acc_invmontgomery(poly *w,
   pointwise_acc_avx(w->coeffs, u->vec->coeffs, v->vec->coeffs);
 }
 
+/*************************************************
+* Name:        polyvecl_pointwise_acc_invntt
+*
+* Description: Compute inner product of vectors of polynomials of length L
+*              in NTT domain and transform the result back to normal domain,
+*              i.e. one row of a matrix-vector product. The products are
+*              accumulated in 64-bit lanes without intermediate reductions.
+*              Coefficients of u are assumed to be less than Q and those of
+*              v less than 22*Q, so the sum of all L products is at most
+*              Q*2^32 and is brought below 2*Q by a single Montgomery
+*              reduction, as required by the inverse NTT. Output
+*              coefficients are less than 2*Q.
+*
+* Arguments:   - poly *w: output polynomial
+*              - const polyvecl *u: pointer to first input vector
+*              - const polyvecl *v: pointer to second input vector
+**************************************************/
+void polyvecl_pointwise_acc_invntt(poly *w,
+                                   const polyvecl *u,
+                                   const polyvecl *v)
+{
+  pointwise_acc_avx(w->coeffs, u->vec->coeffs, v->vec->coeffs);
+  poly_invntt_montgomery(w);
+}
+
 /*************************************************
 * Name:        polyvecl_chknorm
 *
@@ -207,10 +273,7 @@ void polyveck_shiftl(polyveck *v) {
 * Arguments:   - polyveck *v: pointer to input/output vector
 **************************************************/
 void polyveck_ntt(polyveck *v) {
-  unsigned int i;
-
-  for(i = 0; i < K; ++i)
-    poly_ntt(&v->vec[i]);
+  polyvec_ntt(v->vec, K);
 }
 
 /*************************************************
@@ -223,10 +286,7 @@ void polyveck_ntt(polyveck *v) {
 * Arguments:   - polyveck *v: pointer to input/output vector
 **************************************************/
 void polyveck_invntt_montgomery(polyveck *v) {
-  unsigned int i;
-
-  for(i = 0; i < K; ++i)
-    poly_invntt_montgomery(&v->vec[i]);
+  polyvec_invntt_montgomery(v->vec, K);
 }
 
 /*************************************************
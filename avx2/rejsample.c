@@ -272,41 +272,77 @@ unsigned int rej_uniform(uint32_t *r,
                          const unsigned char *buf,
                          unsigned int buflen)
 {
-  unsigned int i, ctr, pos;
-  uint32_t vec[8];
-  __m256i d, tmp;
-  uint32_t good;
+  unsigned int ctr, pos;
+  uint32_t t, good0, good1;
+  __m256i d0, d1, tmp0, tmp1;
+  __m128i rid;
   const __m256i bound = _mm256_set1_epi32(Q);
+  const __m256i mask = _mm256_set1_epi32(0x7FFFFF);
+  const __m256i idx8 = _mm256_set_epi8(-1,15,14,13,-1,12,11,10,
+                                       -1, 9, 8, 7,-1, 6, 5, 4,
+                                       -1,11,10, 9,-1, 8, 7, 6,
+                                       -1, 5, 4, 3,-1, 2, 1, 0);
   DBENCH_START();
 
+  /* Two vectors of 8 coefficients from 48 bytes; the second 32-byte load
+     ends at pos + 56 */
   ctr = pos = 0;
-  while(ctr + 8 <= len && pos + 24 <= buflen) {
-    for(i = 0; i < 8; i++) {
-      vec[i]  = buf[pos++];
-      vec[i] |= (uint32_t)buf[pos++] << 8;
-      vec[i] |= (uint32_t)buf[pos++] << 16;
-      vec[i] &= 0x7FFFFF;
-    }
+  while(ctr + 16 <= len && pos + 56 <= buflen) {
+    d0 = _mm256_loadu_si256((__m256i *)&buf[pos]);
+    d1 = _mm256_loadu_si256((__m256i *)&buf[pos + 24]);
+    pos += 48;
+
+    d0 = _mm256_permute4x64_epi64(d0, 0x94);
+    d1 = _mm256_permute4x64_epi64(d1, 0x94);
+    d0 = _mm256_shuffle_epi8(d0, idx8);
+    d1 = _mm256_shuffle_epi8(d1, idx8);
+    d0 = _mm256_and_si256(d0, mask);
+    d1 = _mm256_and_si256(d1, mask);
+
+    tmp0 = _mm256_cmpgt_epi32(bound, d0);
+    tmp1 = _mm256_cmpgt_epi32(bound, d1);
+    good0 = _mm256_movemask_ps((__m256)tmp0);
+    good1 = _mm256_movemask_ps((__m256)tmp1);
+
+    rid = _mm_loadl_epi64((__m128i *)&idx[good0]);
+    tmp0 = _mm256_cvtepu8_epi32(rid);
+    d0 = _mm256_permutevar8x32_epi32(d0, tmp0);
+    rid = _mm_loadl_epi64((__m128i *)&idx[good1]);
+    tmp1 = _mm256_cvtepu8_epi32(rid);
+    d1 = _mm256_permutevar8x32_epi32(d1, tmp1);
+
+    _mm256_storeu_si256((__m256i *)&r[ctr], d0);
+    ctr += __builtin_popcount(good0);
+    _mm256_storeu_si256((__m256i *)&r[ctr], d1);
+    ctr += __builtin_popcount(good1);
+  }
+
+  while(ctr + 8 <= len && pos + 32 <= buflen) {
+    d0 = _mm256_loadu_si256((__m256i *)&buf[pos]);
+    pos += 24;
+
+    d0 = _mm256_permute4x64_epi64(d0, 0x94);
+    d0 = _mm256_shuffle_epi8(d0, idx8);
+    d0 = _mm256_and_si256(d0, mask);
 
-    d = _mm256_loadu_si256((__m256i *)vec);
-    tmp = _mm256_cmpgt_epi32(bound, d);
-    good = _mm256_movemask_ps((__m256)tmp);
+    tmp0 = _mm256_cmpgt_epi32(bound, d0);
+    good0 = _mm256_movemask_ps((__m256)tmp0);
 
-    __m128i rid = _mm_loadl_epi64((__m128i *)&idx[good]);
-    tmp = _mm256_cvtepu8_epi32(rid);
-    d = _mm256_permutevar8x32_epi32(d, tmp);
-    _mm256_storeu_si256((__m256i *)&r[ctr], d);
-    ctr += __builtin_popcount(good);
+    rid = _mm_loadl_epi64((__m128i *)&idx[good0]);
+    tmp0 = _mm256_cvtepu8_epi32(rid);
+    d0 = _mm256_permutevar8x32_epi32(d0, tmp0);
+    _mm256_storeu_si256((__m256i *)&r[ctr], d0);
+    ctr += __builtin_popcount(good0);
   }
 
   while(ctr < len && pos + 3 <= buflen) {
-    vec[0]  = buf[pos++];
-    vec[0] |= (uint32_t)buf[pos++] << 8;
-    vec[0] |= (uint32_t)buf[pos++] << 16;
-    vec[0] &= 0x7FFFFF;
+    t  = buf[pos++];
+    t |= (uint32_t)buf[pos++] << 8;
+    t |= (uint32_t)buf[pos++] << 16;
+    t &= 0x7FFFFF;
 
-    if(vec[0] < Q)
-      r[ctr++] = vec[0];
+    if(t < Q)
+      r[ctr++] = t;
   }
 
   DBENCH_STOP(*tsample);
@@ -318,28 +354,37 @@ unsigned int rej_eta(uint32_t *r,
                      const unsigned char *buf,
                      unsigned int buflen)
 {
-  unsigned int i, ctr, pos;
-  uint8_t vec[32];
+  unsigned int ctr, pos;
+  uint8_t vec[2];
   __m256i tmp0, tmp1;
   __m128i d0, d1, rid;
   uint32_t good;
   const __m256i bound = _mm256_set1_epi8(2*ETA + 1);
   const __m256i off = _mm256_set1_epi32(Q + ETA);
+#if ETA <= 3
+  const __m256i mask_lo = _mm256_set1_epi16(0x0007);
+  const __m256i mask_hi = _mm256_set1_epi16(0x0700);
+#else
+  const __m256i mask_lo = _mm256_set1_epi16(0x000F);
+  const __m256i mask_hi = _mm256_set1_epi16(0x0F00);
+#endif
   DBENCH_START();
 
   ctr = pos = 0;
   while(ctr + 32 <= len && pos + 16 <= buflen) {
-    for(i = 0; i < 16; i++) {
+    /* Widen each byte to 16 bits and move its high field to the upper
+       byte, giving the 32 fields in stream order */
+    d0 = _mm_loadu_si128((__m128i *)&buf[pos]);
+    pos += 16;
+    tmp0 = _mm256_cvtepu8_epi16(d0);
 #if ETA <= 3
-      vec[2*i+0] = buf[pos] & 0x07;
-      vec[2*i+1] = buf[pos++] >> 5;
+    tmp1 = _mm256_and_si256(_mm256_slli_epi16(tmp0, 3), mask_hi);
 #else
-      vec[2*i+0] = buf[pos] & 0x0F;
-      vec[2*i+1] = buf[pos++] >> 4;
+    tmp1 = _mm256_and_si256(_mm256_slli_epi16(tmp0, 4), mask_hi);
 #endif
-    }
+    tmp0 = _mm256_and_si256(tmp0, mask_lo);
+    tmp0 = _mm256_or_si256(tmp0, tmp1);
 
-    tmp0 = _mm256_loadu_si256((__m256i *)vec);
     tmp1 = _mm256_cmpgt_epi8(bound, tmp0);
     good = _mm256_movemask_epi8(tmp1);
 
@@ -400,39 +445,75 @@ unsigned int rej_gamma1m1(uint32_t *r,
                           const unsigned char *buf,
                           unsigned int buflen)
 {
-  unsigned int i, ctr, pos;
-  uint32_t vec[8];
-  __m256i d, tmp;
-  uint32_t good;
+  unsigned int ctr, pos;
+  uint32_t vec[2], good0, good1;
+  __m256i d0, d1, tmp0, tmp1;
+  __m128i rid;
   const __m256i bound = _mm256_set1_epi32(2*GAMMA1 - 1);
   const __m256i off = _mm256_set1_epi32(Q + GAMMA1 - 1);
+  const __m256i mask = _mm256_set1_epi32(0xFFFFF);
+  const __m256i srlv = _mm256_set_epi32(4, 0, 4, 0, 4, 0, 4, 0);
+  const __m256i idx8 = _mm256_set_epi8(-1,11,10, 9,-1, 9, 8, 7,
+                                       -1, 6, 5, 4,-1, 4, 3, 2,
+                                       -1, 9, 8, 7,-1, 7, 6, 5,
+                                       -1, 4, 3, 2,-1, 2, 1, 0);
   DBENCH_START();
 
+  /* Two vectors of 8 coefficients from 40 bytes; the second 32-byte load
+     ends at pos + 52 */
   ctr = pos = 0;
-  while(ctr + 8 <= len && pos + 20 <= buflen) {
-    for(i = 0; i < 4; i++) {
-      vec[2*i+0]  = buf[pos + 0];
-      vec[2*i+0] |= (uint32_t)buf[pos + 1] << 8;
-      vec[2*i+0] |= (uint32_t)buf[pos + 2] << 16;
-      vec[2*i+0] &= 0xFFFFF;
-
-      vec[2*i+1]  = buf[pos + 2] >> 4;
-      vec[2*i+1] |= (uint32_t)buf[pos + 3] << 4;
-      vec[2*i+1] |= (uint32_t)buf[pos + 4] << 12;
-
-      pos += 5;
-    }
+  while(ctr + 16 <= len && pos + 52 <= buflen) {
+    d0 = _mm256_loadu_si256((__m256i *)&buf[pos]);
+    d1 = _mm256_loadu_si256((__m256i *)&buf[pos + 20]);
+    pos += 40;
+
+    d0 = _mm256_permute4x64_epi64(d0, 0x94);
+    d1 = _mm256_permute4x64_epi64(d1, 0x94);
+    d0 = _mm256_shuffle_epi8(d0, idx8);
+    d1 = _mm256_shuffle_epi8(d1, idx8);
+    d0 = _mm256_srlv_epi32(d0, srlv);
+    d1 = _mm256_srlv_epi32(d1, srlv);
+    d0 = _mm256_and_si256(d0, mask);
+    d1 = _mm256_and_si256(d1, mask);
 
-    d = _mm256_loadu_si256((__m256i *)vec);
-    tmp = _mm256_cmpgt_epi32(bound, d);
-    good = _mm256_movemask_ps((__m256)tmp);
-    d = _mm256_sub_epi32(off, d);
+    tmp0 = _mm256_cmpgt_epi32(bound, d0);
+    tmp1 = _mm256_cmpgt_epi32(bound, d1);
+    good0 = _mm256_movemask_ps((__m256)tmp0);
+    good1 = _mm256_movemask_ps((__m256)tmp1);
+    d0 = _mm256_sub_epi32(off, d0);
+    d1 = _mm256_sub_epi32(off, d1);
 
-    __m128i rid = _mm_loadl_epi64((__m128i *)&idx[good]);
-    tmp = _mm256_cvtepu8_epi32(rid);
-    d = _mm256_permutevar8x32_epi32(d, tmp);
-    _mm256_storeu_si256((__m256i *)&r[ctr], d);
-    ctr += __builtin_popcount(good);
+    rid = _mm_loadl_epi64((__m128i *)&idx[good0]);
+    tmp0 = _mm256_cvtepu8_epi32(rid);
+    d0 = _mm256_permutevar8x32_epi32(d0, tmp0);
+    rid = _mm_loadl_epi64((__m128i *)&idx[good1]);
+    tmp1 = _mm256_cvtepu8_epi32(rid);
+    d1 = _mm256_permutevar8x32_epi32(d1, tmp1);
+
+    _mm256_storeu_si256((__m256i *)&r[ctr], d0);
+    ctr += __builtin_popcount(good0);
+    _mm256_storeu_si256((__m256i *)&r[ctr], d1);
+    ctr += __builtin_popcount(good1);
+  }
+
+  while(ctr + 8 <= len && pos + 32 <= buflen) {
+    d0 = _mm256_loadu_si256((__m256i *)&buf[pos]);
+    pos += 20;
+
+    d0 = _mm256_permute4x64_epi64(d0, 0x94);
+    d0 = _mm256_shuffle_epi8(d0, idx8);
+    d0 = _mm256_srlv_epi32(d0, srlv);
+    d0 = _mm256_and_si256(d0, mask);
+
+    tmp0 = _mm256_cmpgt_epi32(bound, d0);
+    good0 = _mm256_movemask_ps((__m256)tmp0);
+    d0 = _mm256_sub_epi32(off, d0);
+
+    rid = _mm_loadl_epi64((__m128i *)&idx[good0]);
+    tmp0 = _mm256_cvtepu8_epi32(rid);
+    d0 = _mm256_permutevar8x32_epi32(d0, tmp0);
+    _mm256_storeu_si256((__m256i *)&r[ctr], d0);
+    ctr += __builtin_popcount(good0);
   }
 
   while(ctr < len && pos + 5 <= buflen) {
@@ -456,3 +537,190 @@ unsigned int rej_gamma1m1(uint32_t *r,
   DBENCH_STOP(*tsample);
   return ctr;
 }
+
+/*
+ * Four-way samplers reading the output of a 4-way Keccak state directly.
+ * Row i of rows[] holds the 64-bit output word i of the four instances,
+ * as in the __m256i state after a permutation. Coefficients are appended
+ * to r[j] from ctr[j] on until ctr[j] reaches len; ctr[] is updated. The
+ * samples are the same as those of the byte-oriented samplers on the
+ * concatenated output of each instance.
+ */
+static inline void store_good(uint32_t *r,
+                              unsigned int *ctr,
+                              unsigned int len,
+                              __m256i d,
+                              uint32_t good)
+{
+  unsigned int i;
+  uint32_t vec[8];
+  __m128i rid;
+
+  if(*ctr + 8 <= len) {
+    rid = _mm_loadl_epi64((__m128i *)&idx[good]);
+    d = _mm256_permutevar8x32_epi32(d, _mm256_cvtepu8_epi32(rid));
+    _mm256_storeu_si256((__m256i *)&r[*ctr], d);
+    *ctr += __builtin_popcount(good);
+  }
+  else {
+    _mm256_storeu_si256((__m256i *)vec, d);
+    for(i = 0; i < 8 && *ctr < len; ++i)
+      if((good >> i) & 1)
+        r[(*ctr)++] = vec[i];
+  }
+}
+
+/* Gather output words (w0, w1, w1, w2) of each instance from three rows */
+static inline void rows_to_lanes(__m256i d[4],
+                                 __m256i w0,
+                                 __m256i w1,
+                                 __m256i w2)
+{
+  __m256i t0, t1, t2, t3;
+
+  t0 = _mm256_unpacklo_epi64(w0, w1);
+  t1 = _mm256_unpackhi_epi64(w0, w1);
+  t2 = _mm256_unpacklo_epi64(w1, w2);
+  t3 = _mm256_unpackhi_epi64(w1, w2);
+  d[0] = _mm256_permute2x128_si256(t0, t2, 0x20);
+  d[1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+  d[2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+  d[3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+}
+
+/* Consumes rows in groups of 3; returns the number of rows consumed */
+unsigned int rej_uniform_4x(uint32_t *r[4],
+                            unsigned int ctr[4],
+                            unsigned int len,
+                            const __m256i *rows,
+                            unsigned int nrows)
+{
+  unsigned int i, j;
+  uint32_t good;
+  __m256i d[4], tmp;
+  const __m256i bound = _mm256_set1_epi32(Q);
+  const __m256i mask = _mm256_set1_epi32(0x7FFFFF);
+  const __m256i idx8 = _mm256_set_epi8(-1,15,14,13,-1,12,11,10,
+                                       -1, 9, 8, 7,-1, 6, 5, 4,
+                                       -1,11,10, 9,-1, 8, 7, 6,
+                                       -1, 5, 4, 3,-1, 2, 1, 0);
+  DBENCH_START();
+
+  for(i = 0; i + 3 <= nrows; i += 3) {
+    rows_to_lanes(d, rows[i], rows[i+1], rows[i+2]);
+    for(j = 0; j < 4; ++j) {
+      if(ctr[j] >= len)
+        continue;
+      d[j] = _mm256_shuffle_epi8(d[j], idx8);
+      d[j] = _mm256_and_si256(d[j], mask);
+      tmp = _mm256_cmpgt_epi32(bound, d[j]);
+      good = _mm256_movemask_ps((__m256)tmp);
+      store_good(r[j], &ctr[j], len, d[j], good);
+    }
+  }
+
+  DBENCH_STOP(*tsample);
+  return i;
+}
+
+/* Consumes all rows */
+unsigned int rej_eta_4x(uint32_t *r[4],
+                        unsigned int ctr[4],
+                        unsigned int len,
+                        const __m256i *rows,
+                        unsigned int nrows)
+{
+  unsigned int i, j, k, n;
+  uint32_t good;
+  __m256i t[2], f, d;
+  __m128i g;
+  const __m256i bound = _mm256_set1_epi8(2*ETA + 1);
+  const __m256i off = _mm256_set1_epi32(Q + ETA);
+#if ETA <= 3
+  const __m256i mask_lo = _mm256_set1_epi16(0x0007);
+  const __m256i mask_hi = _mm256_set1_epi16(0x0700);
+#else
+  const __m256i mask_lo = _mm256_set1_epi16(0x000F);
+  const __m256i mask_hi = _mm256_set1_epi16(0x0F00);
+#endif
+  DBENCH_START();
+
+  for(i = 0; i < nrows; i += 2) {
+    /* 16 bytes (32 fields) per instance, or 8 from a last odd row */
+    n = (i + 2 <= nrows) ? 4 : 2;
+    f = (n == 4) ? rows[i+1] : _mm256_setzero_si256();
+    t[0] = _mm256_unpacklo_epi64(rows[i], f);
+    t[1] = _mm256_unpackhi_epi64(rows[i], f);
+
+    for(j = 0; j < 4; ++j) {
+      if(ctr[j] >= len)
+        continue;
+      g = (j < 2) ? _mm256_castsi256_si128(t[j])
+                  : _mm256_extracti128_si256(t[j-2], 1);
+      f = _mm256_cvtepu8_epi16(g);
+#if ETA <= 3
+      d = _mm256_and_si256(_mm256_slli_epi16(f, 3), mask_hi);
+#else
+      d = _mm256_and_si256(_mm256_slli_epi16(f, 4), mask_hi);
+#endif
+      f = _mm256_or_si256(_mm256_and_si256(f, mask_lo), d);
+      good = _mm256_movemask_epi8(_mm256_cmpgt_epi8(bound, f));
+
+      for(k = 0; k < n; ++k) {
+        g = (k < 2) ? _mm256_castsi256_si128(f)
+                    : _mm256_extracti128_si256(f, 1);
+        g = (k & 1) ? _mm_bsrli_si128(g, 8) : g;
+        d = _mm256_sub_epi32(off, _mm256_cvtepu8_epi32(g));
+        store_good(r[j], &ctr[j], len, d, (good >> 8*k) & 0xFF);
+      }
+    }
+  }
+
+  DBENCH_STOP(*tsample);
+  return nrows;
+}
+
+/* Consumes rows in groups of 5; returns the number of rows consumed */
+unsigned int rej_gamma1m1_4x(uint32_t *r[4],
+                             unsigned int ctr[4],
+                             unsigned int len,
+                             const __m256i *rows,
+                             unsigned int nrows)
+{
+  unsigned int i, j, k;
+  uint32_t good;
+  __m256i d[2][4], tmp;
+  const __m256i bound = _mm256_set1_epi32(2*GAMMA1 - 1);
+  const __m256i off = _mm256_set1_epi32(Q + GAMMA1 - 1);
+  const __m256i mask = _mm256_set1_epi32(0xFFFFF);
+  const __m256i srlv = _mm256_set_epi32(4, 0, 4, 0, 4, 0, 4, 0);
+  /* Bytes 0-19 of (w0, w1, w1, w2) and bytes 4-23 of (w2, w3, w3, w4) */
+  const __m256i idx8[2] = {
+    _mm256_set_epi8(-1,11,10, 9,-1, 9, 8, 7,-1, 6, 5, 4,-1, 4, 3, 2,
+                    -1, 9, 8, 7,-1, 7, 6, 5,-1, 4, 3, 2,-1, 2, 1, 0),
+    _mm256_set_epi8(-1,15,14,13,-1,13,12,11,-1,10, 9, 8,-1, 8, 7, 6,
+                    -1,13,12,11,-1,11,10, 9,-1, 8, 7, 6,-1, 6, 5, 4)
+  };
+  DBENCH_START();
+
+  for(i = 0; i + 5 <= nrows; i += 5) {
+    rows_to_lanes(d[0], rows[i], rows[i+1], rows[i+2]);
+    rows_to_lanes(d[1], rows[i+2], rows[i+3], rows[i+4]);
+    for(j = 0; j < 4; ++j) {
+      for(k = 0; k < 2; ++k) {
+        if(ctr[j] >= len)
+          break;
+        d[k][j] = _mm256_shuffle_epi8(d[k][j], idx8[k]);
+        d[k][j] = _mm256_srlv_epi32(d[k][j], srlv);
+        d[k][j] = _mm256_and_si256(d[k][j], mask);
+        tmp = _mm256_cmpgt_epi32(bound, d[k][j]);
+        good = _mm256_movemask_ps((__m256)tmp);
+        d[k][j] = _mm256_sub_epi32(off, d[k][j]);
+        store_good(r[j], &ctr[j], len, d[k][j], good);
+      }
+    }
+  }
+
+  DBENCH_STOP(*tsample);
+  return i;
+}
@@ -2,6 +2,7 @@
 #define REJSAMPLE_H
 
 #include <stdint.h>
+#include <immintrin.h>
 
 unsigned int rej_uniform(uint32_t *r,
                          unsigned int len,
@@ -15,5 +16,20 @@ unsigned int rej_gamma1m1(uint32_t *r,
                           unsigned int len,
                           const unsigned char *buf,
                           unsigned int buflen);
+unsigned int rej_uniform_4x(uint32_t *r[4],
+                            unsigned int ctr[4],
+                            unsigned int len,
+                            const __m256i *rows,
+                            unsigned int nrows);
+unsigned int rej_eta_4x(uint32_t *r[4],
+                        unsigned int ctr[4],
+                        unsigned int len,
+                        const __m256i *rows,
+                        unsigned int nrows);
+unsigned int rej_gamma1m1_4x(uint32_t *r[4],
+                             unsigned int ctr[4],
+                             unsigned int len,
+                             const __m256i *rows,
+                             unsigned int nrows);
 
 #endif
@@ -7,167 +7,260 @@
 #include "poly.h"
 #include "polyvec.h"
 #include "packing.h"
+#include "matcache.h"
+#include "signstats.h"
+
+/*************************************************
+* Name:        expand_mat_jobs
+*
+* Description: Fill in the sampling jobs generating matrix A.
+*
+* Arguments:   - sample_job *jobs: array of K*L output jobs
+*              - polyvecl mat[K]: output matrix
+*              - const unsigned char rho[]: byte array containing seed rho
+**************************************************/
+static void expand_mat_jobs(sample_job *jobs,
+                            polyvecl mat[K],
+                            const unsigned char rho[SEEDBYTES])
+{
+  unsigned int i, j;
+
+  for(i = 0; i < K; ++i) {
+    for(j = 0; j < L; ++j) {
+      jobs[i*L + j].a = &mat[i].vec[j];
+      jobs[i*L + j].seed = rho;
+      jobs[i*L + j].nonce = (i << 8) + j;
+      jobs[i*L + j].type = SAMPLE_UNIFORM;
+    }
+  }
+}
 
 /*************************************************
 * Name:        expand_mat
 *
 * Description: Implementation of ExpandA. Generates matrix A with uniformly
 *              random coefficients a_{i,j} by performing rejection
-*              sampling on the output stream of SHAKE128(rho|i|j).
+*              sampling on the output stream of SHAKE128(rho|i|j). The
+*              entries are sampled as a job list, see poly_sample_jobs.
 *
 * Arguments:   - polyvecl mat[K]: output matrix
 *              - const unsigned char rho[]: byte array containing seed rho
 **************************************************/
-#ifdef USE_AES
 void expand_mat(polyvecl mat[K], const unsigned char rho[SEEDBYTES]) {
-  unsigned int i, j;
+  sample_job jobs[K*L];
 
-  for(i = 0; i < K; ++i)
-    for(j = 0; j < L; ++j)
-      poly_uniform(&mat[i].vec[j], rho, (i << 8) + j);
-}
-#elif L == 2 && K == 3
-void expand_mat(polyvecl mat[3], const unsigned char rho[SEEDBYTES])
-{
-  poly t0, t1;
-
-  poly_uniform_4x(&mat[0].vec[0],
-                  &mat[0].vec[1],
-                  &mat[1].vec[0],
-                  &mat[1].vec[1],
-                  rho, 0, 1, 256, 257);
-  poly_uniform_4x(&mat[2].vec[0],
-                  &mat[2].vec[1],
-                  &t0,
-                  &t1,
-                  rho, 512, 513, 0, 0);
-}
-#elif L == 3 && K == 4
-void expand_mat(polyvecl mat[4], const unsigned char rho[SEEDBYTES])
-{
-  poly_uniform_4x(&mat[0].vec[0],
-                  &mat[0].vec[1],
-                  &mat[0].vec[2],
-                  &mat[1].vec[0],
-                  rho, 0, 1, 2, 256);
-  poly_uniform_4x(&mat[1].vec[1],
-                  &mat[1].vec[2],
-                  &mat[2].vec[0],
-                  &mat[2].vec[1],
-                  rho, 257, 258, 512, 513);
-  poly_uniform_4x(&mat[2].vec[2],
-                  &mat[3].vec[0],
-                  &mat[3].vec[1],
-                  &mat[3].vec[2],
-                  rho, 514, 768, 769, 770);
-}
-#elif L == 4 && K == 5
-void expand_mat(polyvecl mat[5], const unsigned char rho[SEEDBYTES])
-{
-  poly_uniform_4x(&mat[0].vec[0],
-                  &mat[0].vec[1],
-                  &mat[0].vec[2],
-                  &mat[0].vec[3],
-                  rho, 0, 1, 2, 3);
-  poly_uniform_4x(&mat[1].vec[0],
-                  &mat[1].vec[1],
-                  &mat[1].vec[2],
-                  &mat[1].vec[3],
-                  rho, 256, 257, 258, 259);
-  poly_uniform_4x(&mat[2].vec[0],
-                  &mat[2].vec[1],
-                  &mat[2].vec[2],
-                  &mat[2].vec[3],
-                  rho, 512, 513, 514, 515);
-  poly_uniform_4x(&mat[3].vec[0],
-                  &mat[3].vec[1],
-                  &mat[3].vec[2],
-                  &mat[3].vec[3],
-                  rho, 768, 769, 770, 771);
-  poly_uniform_4x(&mat[4].vec[0],
-                  &mat[4].vec[1],
-                  &mat[4].vec[2],
-                  &mat[4].vec[3],
-                  rho, 1024, 1025, 1026, 1027);
-}
-#elif L == 5 && K == 6
-void expand_mat(polyvecl mat[6], const unsigned char rho[SEEDBYTES])
-{
-  poly t0, t1;
-
-  poly_uniform_4x(&mat[0].vec[0],
-                  &mat[0].vec[1],
-                  &mat[0].vec[2],
-                  &mat[0].vec[3],
-                  rho, 0, 1, 2, 3);
-  poly_uniform_4x(&mat[0].vec[4],
-                  &mat[1].vec[0],
-                  &mat[1].vec[1],
-                  &mat[1].vec[2],
-                  rho, 4, 256, 257, 258);
-  poly_uniform_4x(&mat[1].vec[3],
-                  &mat[1].vec[4],
-                  &mat[2].vec[0],
-                  &mat[2].vec[1],
-                  rho, 259, 260, 512, 513);
-  poly_uniform_4x(&mat[2].vec[2],
-                  &mat[2].vec[3],
-                  &mat[2].vec[4],
-                  &mat[3].vec[0],
-                  rho, 514, 515, 516, 768);
-  poly_uniform_4x(&mat[3].vec[1],
-                  &mat[3].vec[2],
-                  &mat[3].vec[3],
-                  &mat[3].vec[4],
-                  rho, 769, 770, 771, 772);
-  poly_uniform_4x(&mat[4].vec[0],
-                  &mat[4].vec[1],
-                  &mat[4].vec[2],
-                  &mat[4].vec[3],
-                  rho, 1024, 1025, 1026, 1027);
-  poly_uniform_4x(&mat[4].vec[4],
-                  &mat[5].vec[0],
-                  &mat[5].vec[1],
-                  &mat[5].vec[2],
-                  rho, 1028, 1280, 1281, 1282);
-  poly_uniform_4x(&mat[5].vec[3],
-                  &mat[5].vec[4],
-                  &t0,
-                  &t1,
-                  rho, 1283, 1284, 0, 0);
+  expand_mat_jobs(jobs, mat, rho);
+  poly_sample_jobs(jobs, K*L);
 }
-#else
-#error
-#endif
+
+typedef struct {
+  polyvecl *mat;
+  const unsigned char *rho;
+} expand_mat_task;
+
+typedef struct {
+  const polyvecl *mat;
+  const polyvecl *v;
+  poly *w;
+} matmul_task;
+
+typedef struct {
+  const poly *c;
+  const poly_prepared *v;
+  poly *w;
+} polymul_task;
+
+typedef struct {
+  expanded_sk *esk;
+  const unsigned char *sk;
+} sk_prepare_task;
 
 /*************************************************
-* Name:        challenge
+* Name:        expand_mat_task_run
 *
-* Description: Implementation of H. Samples polynomial with 60 nonzero
-*              coefficients in {-1,1} using the output stream of
-*              SHAKE256(mu|w1).
+* Description: Task generating part of matrix A. Task i generates the
+*              entries 4*i to 4*i+3 of A in row-major order.
 *
-* Arguments:   - poly *c: pointer to output polynomial
-*              - const unsigned char mu[]: byte array containing mu
-*              - const polyveck *w1: pointer to vector w1
+* Arguments:   - void *arg: pointer to expand_mat_task
+*              - unsigned int i: task index
 **************************************************/
-void challenge(poly *c,
-               const unsigned char mu[CRHBYTES],
-               const polyveck *w1)
+static void expand_mat_task_run(void *arg, unsigned int i) {
+  unsigned int j, k;
+  uint16_t nonce[4];
+  poly *a[4], tmp[4];
+  expand_mat_task *t = arg;
+
+  for(j = 0; j < 4; ++j) {
+    k = 4*i + j;
+    if(k < K*L) {
+      a[j] = &t->mat[k/L].vec[k%L];
+      nonce[j] = ((k/L) << 8) + k%L;
+    }
+    else {
+      a[j] = &tmp[j];
+      nonce[j] = 0;
+    }
+  }
+
+  poly_uniform_4x(a[0], a[1], a[2], a[3], t->rho,
+                  nonce[0], nonce[1], nonce[2], nonce[3]);
+}
+
+#define EXPAND_MAT_TASKS ((K*L + 3)/4)
+
+/*************************************************
+* Name:        expand_mat_parallel
+*
+* Description: Generate matrix A with the work distributed over a thread
+*              pool. Output is identical to expand_mat.
+*
+* Arguments:   - polyvecl mat[K]: output matrix
+*              - const unsigned char rho[]: byte array containing seed rho
+*              - threadpool *pool: pointer to thread pool, may be NULL
+**************************************************/
+static void expand_mat_parallel(polyvecl mat[K],
+                                const unsigned char rho[SEEDBYTES],
+                                threadpool *pool)
+{
+  expand_mat_task t;
+
+  if(!pool || !pool->nthreads) {
+    expand_mat(mat, rho);
+    return;
+  }
+
+  t.mat = mat;
+  t.rho = rho;
+  threadpool_run(pool, expand_mat_task_run, &t, EXPAND_MAT_TASKS);
+}
+
+/*************************************************
+* Name:        matmul_task_run
+*
+* Description: Task computing row i of A*v for v in NTT domain and
+*              transforming it back to normal domain.
+*
+* Arguments:   - void *arg: pointer to matmul_task
+*              - unsigned int i: row index
+**************************************************/
+static void matmul_task_run(void *arg, unsigned int i) {
+  matmul_task *t = arg;
+
+  polyvecl_pointwise_acc_invntt(&t->w[i], &t->mat[i], t->v);
+}
+
+/*************************************************
+* Name:        matmul_parallel
+*
+* Description: Compute w = INTT(A*v) with the K rows distributed over a
+*              thread pool.
+*
+* Arguments:   - poly *w: output array of K polynomials
+*              - const polyvecl mat[K]: matrix A in NTT domain
+*              - const polyvecl *v: pointer to vector in NTT domain
+*              - threadpool *pool: pointer to thread pool, may be NULL
+**************************************************/
+static void matmul_parallel(poly *w,
+                            const polyvecl mat[K],
+                            const polyvecl *v,
+                            threadpool *pool)
+{
+  matmul_task t;
+
+  t.mat = mat;
+  t.v = v;
+  t.w = w;
+  threadpool_run(pool, matmul_task_run, &t, K);
+}
+
+/*************************************************
+* Name:        polymul_task_run
+*
+* Description: Task computing polynomial i of INTT(c*v) for c in NTT domain
+*              and prepared v.
+*
+* Arguments:   - void *arg: pointer to polymul_task
+*              - unsigned int i: polynomial index
+**************************************************/
+static void polymul_task_run(void *arg, unsigned int i) {
+  polymul_task *t = arg;
+
+  poly_pointwise_prepared(&t->w[i], t->c, &t->v[i]);
+  poly_invntt_montgomery(&t->w[i]);
+}
+
+/*************************************************
+* Name:        polymul_parallel
+*
+* Description: Multiply n polynomials by the same polynomial c with the
+*              products distributed over a thread pool.
+*
+* Arguments:   - poly *w: output array of n polynomials
+*              - const poly *c: pointer to polynomial in NTT domain
+*              - const poly_prepared *v: array of n prepared polynomials
+*              - unsigned int n: number of polynomials
+*              - threadpool *pool: pointer to thread pool, may be NULL
+**************************************************/
+static void polymul_parallel(poly *w,
+                             const poly *c,
+                             const poly_prepared *v,
+                             unsigned int n,
+                             threadpool *pool)
 {
+  polymul_task t;
+
+  t.c = c;
+  t.v = v;
+  t.w = w;
+  threadpool_run(pool, polymul_task_run, &t, n);
+}
+
+/*************************************************
+* Name:        sk_prepare_task_run
+*
+* Description: Task unpacking polynomial i of s1|s2|t0 from the secret key,
+*              transforming it to NTT domain and preparing it for
+*              multiplication.
+*
+* Arguments:   - void *arg: pointer to sk_prepare_task
+*              - unsigned int i: polynomial index
+**************************************************/
+static void sk_prepare_task_run(void *arg, unsigned int i) {
+  sk_prepare_task *t = arg;
+  poly_prepared *p;
+
+  if(i < L) {
+    p = &t->esk->s1.vec[i];
+    unpack_sk_s1(&p->w, i, t->sk);
+  }
+  else if(i < L + K) {
+    p = &t->esk->s2.vec[i - L];
+    unpack_sk_s2(&p->w, i - L, t->sk);
+  }
+  else {
+    p = &t->esk->t0.vec[i - L - K];
+    unpack_sk_t0(&p->w, i - L - K, t->sk);
+  }
+
+  poly_ntt(&p->w);
+  poly_prepare(p, &p->w);
+}
+
+/*************************************************
+* Name:        challenge_sample
+*
+* Description: Sample challenge polynomial from SHAKE256 state that has
+*              absorbed mu|w1.
+*
+* Arguments:   - poly *c: pointer to output polynomial
+*              - keccak_state *state: pointer to absorbed SHAKE256 state
+**************************************************/
+static void challenge_sample(poly *c, keccak_state *state) {
   unsigned int i, b, pos;
   uint64_t signs;
-  unsigned char inbuf[CRHBYTES + K*POLW1_SIZE_PACKED];
   unsigned char outbuf[SHAKE256_RATE];
-  keccak_state state;
-
-  for(i = 0; i < CRHBYTES; ++i)
-    inbuf[i] = mu[i];
-  for(i = 0; i < K; ++i)
-    polyw1_pack(inbuf + CRHBYTES + i*POLW1_SIZE_PACKED, &w1->vec[i]);
 
-  shake256_absorb(&state, inbuf, sizeof(inbuf));
-  shake256_squeezeblocks(outbuf, 1, &state);
+  shake256_squeezeblocks(outbuf, 1, state);
 
   signs = 0;
   for(i = 0; i < 8; ++i)
@@ -181,7 +274,7 @@ void challenge(poly *c,
   for(i = 196; i < 256; ++i) {
     do {
       if(pos >= SHAKE256_RATE) {
-        shake256_squeezeblocks(outbuf, 1, &state);
+        shake256_squeezeblocks(outbuf, 1, state);
         pos = 0;
       }
 
@@ -196,19 +289,141 @@ void challenge(poly *c,
 }
 
 /*************************************************
-* Name:        crypto_sign_keypair
+* Name:        challenge
 *
-* Description: Generates public and private key.
+* Description: Implementation of H. Samples polynomial with 60 nonzero
+*              coefficients in {-1,1} using the output stream of
+*              SHAKE256(mu|w1).
+*
+* Arguments:   - poly *c: pointer to output polynomial
+*              - const unsigned char mu[]: byte array containing mu
+*              - const polyveck *w1: pointer to vector w1
+**************************************************/
+void challenge(poly *c,
+               const unsigned char mu[CRHBYTES],
+               const polyveck *w1)
+{
+  unsigned int i;
+  unsigned char inbuf[CRHBYTES + K*POLW1_SIZE_PACKED];
+  keccak_state state;
+
+  for(i = 0; i < CRHBYTES; ++i)
+    inbuf[i] = mu[i];
+  for(i = 0; i < K; ++i)
+    polyw1_pack(inbuf + CRHBYTES + i*POLW1_SIZE_PACKED, &w1->vec[i]);
+
+  shake256_absorb(&state, inbuf, sizeof(inbuf));
+  challenge_sample(c, &state);
+}
+
+#ifndef USE_AES
+/*************************************************
+* Name:        challenge_4x
+*
+* Description: Four-way parallel version of challenge. The SHAKE256 instances
+*              run in the four lanes of the AVX2 Keccak implementation.
+*
+* Arguments:   - poly *c0-c3: pointers to output polynomials
+*              - const unsigned char mu0-mu3[]: byte arrays containing mu
+*              - const polyveck *w1_0-w1_3: pointers to vectors w1
+**************************************************/
+void challenge_4x(poly *c0,
+                  poly *c1,
+                  poly *c2,
+                  poly *c3,
+                  const unsigned char mu0[CRHBYTES],
+                  const unsigned char mu1[CRHBYTES],
+                  const unsigned char mu2[CRHBYTES],
+                  const unsigned char mu3[CRHBYTES],
+                  const polyveck *w1_0,
+                  const polyveck *w1_1,
+                  const polyveck *w1_2,
+                  const polyveck *w1_3)
+{
+  unsigned int i, j, b, done;
+  unsigned int pos[4], ctr[4];
+  uint64_t signs[4];
+  unsigned char inbuf[4][CRHBYTES + K*POLW1_SIZE_PACKED];
+  unsigned char outbuf[4][SHAKE256_RATE];
+  poly *c[4] = {c0, c1, c2, c3};
+  const unsigned char *mu[4] = {mu0, mu1, mu2, mu3};
+  const polyveck *w1[4] = {w1_0, w1_1, w1_2, w1_3};
+  __m256i state[25];
+
+  for(j = 0; j < 4; ++j) {
+    for(i = 0; i < CRHBYTES; ++i)
+      inbuf[j][i] = mu[j][i];
+    for(i = 0; i < K; ++i)
+      polyw1_pack(inbuf[j] + CRHBYTES + i*POLW1_SIZE_PACKED, &w1[j]->vec[i]);
+  }
+
+  shake256_absorb4x(state, inbuf[0], inbuf[1], inbuf[2], inbuf[3],
+                    sizeof(inbuf[0]));
+  shake256_squeezeblocks4x(outbuf[0], outbuf[1], outbuf[2], outbuf[3], 1,
+                           state);
+
+  for(j = 0; j < 4; ++j) {
+    signs[j] = 0;
+    for(i = 0; i < 8; ++i)
+      signs[j] |= (uint64_t)outbuf[j][i] << 8*i;
+
+    pos[j] = 8;
+    ctr[j] = 196;
+
+    for(i = 0; i < N; ++i)
+      c[j]->coeffs[i] = 0;
+  }
+
+  for(;;) {
+    done = 1;
+    for(j = 0; j < 4; ++j) {
+      while(ctr[j] < N && pos[j] < SHAKE256_RATE) {
+        b = outbuf[j][pos[j]++];
+        if(b > ctr[j])
+          continue;
+
+        c[j]->coeffs[ctr[j]] = c[j]->coeffs[b];
+        c[j]->coeffs[b] = 1;
+        c[j]->coeffs[b] ^= -(signs[j] & 1) & (1 ^ (Q-1));
+        signs[j] >>= 1;
+        ++ctr[j];
+      }
+      done &= ctr[j] == N;
+    }
+
+    if(done)
+      break;
+
+    shake256_squeezeblocks4x(outbuf[0], outbuf[1], outbuf[2], outbuf[3], 1,
+                             state);
+    for(j = 0; j < 4; ++j)
+      pos[j] = 0;
+  }
+}
+#endif
+
+/*************************************************
+* Name:        crypto_sign_keypair_parallel
+*
+* Description: Generates public and private key. Expansion of A and the
+*              matrix-vector multiplication are distributed over a thread
+*              pool. Given the same randomness, output is identical to
+*              crypto_sign_keypair.
 *
 * Arguments:   - unsigned char *pk: pointer to output public key (allocated
 *                                   array of CRYPTO_PUBLICKEYBYTES bytes)
 *              - unsigned char *sk: pointer to output private key (allocated
 *                                   array of CRYPTO_SECRETKEYBYTES bytes)
+*              - threadpool *pool: pointer to thread pool, may be NULL
 *
 * Returns 0 (success)
 **************************************************/
-int crypto_sign_keypair(unsigned char *pk, unsigned char *sk) {
-  unsigned int i;
+int crypto_sign_keypair_parallel(unsigned char *pk,
+                                 unsigned char *sk,
+                                 threadpool *pool)
+{
+  unsigned int i, n;
+  sample_job jobs[K*L + L + K];
   unsigned char seedbuf[3*SEEDBYTES];
   unsigned char tr[CRHBYTES];
   const unsigned char *rho, *rhoprime, *key;
@@ -223,53 +438,30 @@ int crypto_sign_keypair(unsigned char *pk, unsigned char *sk) {
   rhoprime = seedbuf + SEEDBYTES;
   key = seedbuf + 2*SEEDBYTES;
 
-  /* Expand matrix */
-  expand_mat(mat, rho);
+  /* Expand matrix and sample short vectors s1 and s2. Without threads
+   * this is a single job list, so s1 and s2 start in the lanes that the
+   * matrix leaves over */
+  n = 0;
+  if(!pool || !pool->nthreads) {
+    expand_mat_jobs(jobs, mat, rho);
+    n = K*L;
+  }
+  else
+    expand_mat_parallel(mat, rho, pool);
 
-  /* Sample short vectors s1 and s2 */
-#ifdef USE_AES
-  for(i = 0; i < L; ++i)
-    poly_uniform_eta(&s1.vec[i], rhoprime, nonce++);
-  for(i = 0; i < K; ++i)
-    poly_uniform_eta(&s2.vec[i], rhoprime, nonce++);
-#elif L == 2 && K == 3
-  poly_uniform_eta_4x(&s1.vec[0], &s1.vec[1], &s2.vec[0], &s2.vec[1], rhoprime,
-                      nonce, nonce + 1, nonce + 2, nonce + 3);
-  poly_uniform_eta(&s2.vec[2], rhoprime, nonce + 4);
-  nonce += 5;
-#elif L == 3 && K == 4
-  poly_uniform_eta_4x(&s1.vec[0], &s1.vec[1], &s1.vec[2], &s2.vec[0], rhoprime,
-                      nonce, nonce + 1, nonce + 2, nonce + 3);
-  poly_uniform_eta_4x(&s2.vec[1], &s2.vec[2], &s2.vec[3], &t.vec[0], rhoprime,
-                      nonce + 4, nonce + 5, nonce + 6, 0);
-  nonce += 7;
-#elif L == 4 && K == 5
-  poly_uniform_eta_4x(&s1.vec[0], &s1.vec[1], &s1.vec[2], &s1.vec[3], rhoprime,
-                      nonce, nonce + 1, nonce + 2, nonce + 3);
-  poly_uniform_eta_4x(&s2.vec[0], &s2.vec[1], &s2.vec[2], &s2.vec[3], rhoprime,
-                      nonce + 4, nonce + 5, nonce + 6, nonce + 7);
-  poly_uniform_eta(&s2.vec[4], rhoprime, nonce + 8);
-  nonce += 9;
-#elif L == 5 && K == 6
-  poly_uniform_eta_4x(&s1.vec[0], &s1.vec[1], &s1.vec[2], &s1.vec[3], rhoprime,
-                      nonce, nonce + 1, nonce + 2, nonce + 3);
-  poly_uniform_eta_4x(&s1.vec[4], &s2.vec[0], &s2.vec[1], &s2.vec[2], rhoprime,
-                      nonce + 4, nonce + 5, nonce + 6, nonce + 7);
-  poly_uniform_eta_4x(&s2.vec[3], &s2.vec[4], &s2.vec[5], &t.vec[0], rhoprime,
-                      nonce + 8, nonce + 9, nonce + 10, 0);
-  nonce += 11;
-#else
-#error ""
-#endif
+  for(i = 0; i < L + K; ++i) {
+    jobs[n].a = (i < L) ? &s1.vec[i] : &s2.vec[i - L];
+    jobs[n].seed = rhoprime;
+    jobs[n].nonce = nonce++;
+    jobs[n].type = SAMPLE_ETA;
+    ++n;
+  }
+  poly_sample_jobs(jobs, n);
 
   /* Matrix-vector multiplication */
   s1hat = s1;
   polyvecl_ntt(&s1hat);
-  for(i = 0; i < K; ++i) {
-    polyvecl_pointwise_acc_invmontgomery(&t.vec[i], &mat[i], &s1hat);
-    //poly_reduce(&t.vec[i]);
-    poly_invntt_montgomery(&t.vec[i]);
-  }
+  matmul_parallel(t.vec, mat, &s1hat, pool);
 
   /* Add error vector s2 */
   polyveck_add(&t, &t, &s2);
@@ -287,150 +479,990 @@ int crypto_sign_keypair(unsigned char *pk, unsigned char *sk) {
 }
 
 /*************************************************
-* Name:        crypto_sign
+* Name:        crypto_sign_keypair
 *
-* Description: Compute signed message.
+* Description: Generates public and private key.
 *
-* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
-*                                   array with CRYPTO_BYTES + mlen bytes),
-*                                   can be equal to m
-*              - unsigned long long *smlen: pointer to output length of signed
-*                                           message
-*              - const unsigned char *m: pointer to message to be signed
-*              - unsigned long long mlen: length of message
+* Arguments:   - unsigned char *pk: pointer to output public key (allocated
+*                                   array of CRYPTO_PUBLICKEYBYTES bytes)
+*              - unsigned char *sk: pointer to output private key (allocated
+*                                   array of CRYPTO_SECRETKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_keypair(unsigned char *pk, unsigned char *sk) {
+  return crypto_sign_keypair_parallel(pk, sk, NULL);
+}
+
+/*************************************************
+* Name:        crypto_sign_sk_expand_parallel
+*
+* Description: Same as crypto_sign_sk_expand, but expansion of A and the
+*              preparation of s1, s2 and t0 are distributed over a thread
+*              pool.
+*
+* Arguments:   - expanded_sk *esk: pointer to output expanded secret key
 *              - const unsigned char *sk: pointer to bit-packed secret key
+*              - threadpool *pool: pointer to thread pool, may be NULL
 *
 * Returns 0 (success)
 **************************************************/
-int crypto_sign(unsigned char *sm,
-                unsigned long long *smlen,
-                const unsigned char *m,
-                unsigned long long mlen,
-                const unsigned char *sk)
+int crypto_sign_sk_expand_parallel(expanded_sk *esk,
+                                   const unsigned char *sk,
+                                   threadpool *pool)
 {
-  unsigned long long i;
-  unsigned int n;
-  unsigned char seedbuf[2*SEEDBYTES + 3*CRHBYTES];
-  unsigned char *rho, *tr, *key, *mu, *rhoprime;
-  uint16_t nonce = 0;
-  poly c, chat;
-  polyvecl mat[K], s1, y, yhat, z;
-  polyveck t0, s2, w, w1, w0;
-  polyveck h, cs2, ct0;
-
-  rho = seedbuf;
-  tr = rho + SEEDBYTES;
-  key = tr + CRHBYTES;
-  mu = key + SEEDBYTES;
-  rhoprime = mu + CRHBYTES;
-  unpack_sk(rho, key, tr, &s1, &s2, &t0, sk);
+  unsigned int i;
+  const unsigned char *rho = sk;
+  sk_prepare_task t;
 
-  /* Copy tr and message into the sm buffer,
-   * backwards since m and sm can be equal in SUPERCOP API */
-  for(i = 1; i <= mlen; ++i)
-    sm[CRYPTO_BYTES + mlen - i] = m[mlen - i];
+  for(i = 0; i < SEEDBYTES; ++i)
+    esk->key[i] = sk[SEEDBYTES + i];
   for(i = 0; i < CRHBYTES; ++i)
-    sm[CRYPTO_BYTES - CRHBYTES + i] = tr[i];
+    esk->tr[i] = sk[2*SEEDBYTES + i];
 
-  /* Compute CRH(tr, msg) */
-  crh(mu, sm + CRYPTO_BYTES - CRHBYTES, CRHBYTES + mlen);
+  if(!matcache_get(esk->mat, rho)) {
+    expand_mat_parallel(esk->mat, rho, pool);
+    matcache_put(esk->mat, rho);
+  }
+
+  t.esk = esk;
+  t.sk = sk;
+  threadpool_run(pool, sk_prepare_task_run, &t, L + 2*K);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_sk_expand
+*
+* Description: Precompute all message-independent parts of signing for a
+*              secret key, i.e. the matrix A and the NTTs of s1, s2 and t0
+*              prepared for multiplication by the challenge.
+*              See sign.h for the size of the expanded key.
+*
+* Arguments:   - expanded_sk *esk: pointer to output expanded secret key
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_sk_expand(expanded_sk *esk, const unsigned char *sk) {
+  return crypto_sign_sk_expand_parallel(esk, sk, NULL);
+}
+
+/*************************************************
+* Name:        compute_mu
+*
+* Description: Compute mu = CRH(tr, msg) without copying the message.
+*
+* Arguments:   - unsigned char mu[]: output byte array for mu
+*              - const unsigned char tr[]: byte array containing tr
+*              - const unsigned char *m: pointer to message
+*              - unsigned long long mlen: length of message
+**************************************************/
+static void compute_mu(unsigned char mu[CRHBYTES],
+                       const unsigned char tr[CRHBYTES],
+                       const unsigned char *m,
+                       unsigned long long mlen)
+{
+  keccak_state state;
+
+  shake256_inc_init(&state);
+  shake256_inc_absorb(&state, tr, CRHBYTES);
+  shake256_inc_absorb(&state, m, mlen);
+  shake256_inc_finalize(&state);
+  shake256_inc_squeeze(mu, CRHBYTES, &state);
+}
+
+#if defined(SPECULATIVE_SIGNING) && !defined(USE_AES)
+typedef struct {
+  const polyvecl *mat;
+  const polyvecl *v;
+  polyveck *w;
+} matmul4x_task;
+
+/*************************************************
+* Name:        matmul4x_task_run
+*
+* Description: Task computing row i of A*v_j for four vectors v_j in NTT
+*              domain, so that row i of A is read from memory once for all
+*              four products, and transforming the results back to normal
+*              domain with the 4-way inverse NTT.
+*
+* Arguments:   - void *arg: pointer to matmul4x_task
+*              - unsigned int i: row index
+**************************************************/
+static void matmul4x_task_run(void *arg, unsigned int i) {
+  unsigned int j;
+  matmul4x_task *t = arg;
+
+  for(j = 0; j < 4; ++j)
+    polyvecl_pointwise_acc_invmontgomery(&t->w[j].vec[i], &t->mat[i],
+                                         &t->v[j]);
+  poly_invntt_montgomery_4x(&t->w[0].vec[i], &t->w[1].vec[i],
+                            &t->w[2].vec[i], &t->w[3].vec[i]);
+}
+
+/*************************************************
+* Name:        sign_mu
+*
+* Description: Compute signature of message representative mu. Speculative
+*              version that computes y, w and the challenge for four
+*              consecutive rejection-loop iterations at once, so that all
+*              lanes of the 4-way Keccak are used for sampling y and hashing
+*              the challenges, the NTTs of y run four at a time and every
+*              row of A is used for all four candidates while it is in
+*              cache. Candidates are then checked in nonce order and
+*              the first acceptable one is output, so signatures are identical
+*              to the ones of the non-speculative version.
+*
+* Arguments:   - unsigned char sig[]: output byte array for signature
+*              - const unsigned char mu[]: byte array containing mu
+*              - const expanded_sk *esk: pointer to expanded secret key
+*              - threadpool *pool: pointer to thread pool for distributing
+*                                  the polynomial multiplications, may be NULL
+**************************************************/
+static void sign_mu(unsigned char sig[CRYPTO_BYTES],
+                    const unsigned char mu[CRHBYTES],
+                    const expanded_sk *esk,
+                    sign_scratch *s,
+                    threadpool *pool)
+{
+  unsigned int i, j, n;
+  unsigned char seedbuf[SEEDBYTES + 2*CRHBYTES];
+  unsigned char *rhoprime;
+  uint16_t nonce = 0;
+  poly c[4], chat;
+  polyvecl *y = s->y, *yhat = s->yhat, *z = &s->z;
+  polyveck *w = s->w, *w1 = s->w1, *w0 = &s->w0;
+  polyveck *h = &s->h, *cs2 = &s->cs2, *ct0 = &s->ct0;
+  matmul4x_task t;
+
+  rhoprime = seedbuf + SEEDBYTES + CRHBYTES;
+  for(i = 0; i < SEEDBYTES; ++i)
+    seedbuf[i] = esk->key[i];
+  for(i = 0; i < CRHBYTES; ++i)
+    seedbuf[SEEDBYTES + i] = mu[i];
 
 #ifdef RANDOMIZED_SIGNING
   randombytes(rhoprime, CRHBYTES);
 #else
-  crh(rhoprime, key, SEEDBYTES + CRHBYTES);
+  crh(rhoprime, seedbuf, SEEDBYTES + CRHBYTES);
 #endif
 
-  /* Expand matrix and transform vectors */
-  expand_mat(mat, rho);
-  polyvecl_ntt(&s1);
-  polyveck_ntt(&s2);
-  polyveck_ntt(&t0);
+  SIGNSTATS_BEGIN();
 
   rej:
-  /* Sample intermediate vector y */
-#ifdef USE_AES
+  /* Sample intermediate vectors y of four candidates; candidate j uses
+   * the same nonces as iteration j of the non-speculative loop */
+  for(i = 0; i < 4*L; i += 4)
+    poly_uniform_gamma1m1_4x(&y[i/L].vec[i%L],
+                             &y[(i+1)/L].vec[(i+1)%L],
+                             &y[(i+2)/L].vec[(i+2)%L],
+                             &y[(i+3)/L].vec[(i+3)%L],
+                             rhoprime, nonce + i, nonce + i + 1,
+                             nonce + i + 2, nonce + i + 3);
+  nonce += 4*L;
+
+  /* Matrix-vector multiplications and decomposition */
+  for(j = 0; j < 4; ++j)
+    yhat[j] = y[j];
   for(i = 0; i < L; ++i)
-    poly_uniform_gamma1m1(&y.vec[i], rhoprime, nonce++);
-#elif L == 2
-  poly_uniform_gamma1m1_4x(&y.vec[0], &y.vec[1], &yhat.vec[0], &yhat.vec[1],
-                           rhoprime, nonce, nonce + 1, 0, 0);
-  nonce += 2;
-#elif L == 3
-  poly_uniform_gamma1m1_4x(&y.vec[0], &y.vec[1], &y.vec[2], &yhat.vec[0],
-                           rhoprime, nonce, nonce + 1, nonce + 2, 0);
-  nonce += 3;
-#elif L == 4
-  poly_uniform_gamma1m1_4x(&y.vec[0], &y.vec[1], &y.vec[2], &y.vec[3],
+    poly_ntt_4x(&yhat[0].vec[i], &yhat[1].vec[i], &yhat[2].vec[i],
+                &yhat[3].vec[i]);
+
+  t.mat = esk->mat;
+  t.v = yhat;
+  t.w = w;
+  threadpool_run(pool, matmul4x_task_run, &t, K);
+
+  for(j = 0; j < 4; ++j) {
+    polyveck_csubq(&w[j]);
+    polyveck_decompose(&w1[j], w0, &w[j]);
+  }
+
+  /* Call the random oracle for all candidates */
+  challenge_4x(&c[0], &c[1], &c[2], &c[3], mu, mu, mu, mu,
+               &w1[0], &w1[1], &w1[2], &w1[3]);
+
+  for(j = 0; j < 4; ++j) {
+    chat = c[j];
+    poly_ntt(&chat);
+
+    /* Check that subtracting cs2 does not change high bits of w and low
+     * bits do not reveal secret information. Only w1 of the candidates
+     * is kept, w0 is recomputed from w */
+    polyveck_decompose(&w1[j], w0, &w[j]);
+    polymul_parallel(cs2->vec, &chat, esk->s2.vec, K, pool);
+    polyveck_sub(w0, w0, cs2);
+    polyveck_freeze(w0);
+    if(polyveck_chknorm(w0, GAMMA2 - BETA)) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_W0);
+      continue;
+    }
+
+    /* Compute z, reject if it reveals secret */
+    polymul_parallel(z->vec, &chat, esk->s1.vec, L, pool);
+    polyvecl_add(z, z, &y[j]);
+    polyvecl_freeze(z);
+    if(polyvecl_chknorm(z, GAMMA1 - BETA)) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_Z);
+      continue;
+    }
+
+    /* Compute hints for w1 */
+    polymul_parallel(ct0->vec, &chat, esk->t0.vec, K, pool);
+
+    polyveck_csubq(ct0);
+    if(polyveck_chknorm(ct0, GAMMA2)) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_CT0);
+      continue;
+    }
+
+    polyveck_add(w0, w0, ct0);
+    polyveck_csubq(w0);
+    n = polyveck_make_hint(h, w0, &w1[j]);
+    if(n > OMEGA) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_HINT);
+      continue;
+    }
+
+    SIGNSTATS_ACCEPT();
+
+    /* Write signature */
+    pack_sig(sig, z, h, &c[j]);
+    return;
+  }
+
+  goto rej;
+}
+#else
+/*************************************************
+* Name:        sign_mu
+*
+* Description: Compute signature of message representative mu.
+*
+* Arguments:   - unsigned char sig[]: output byte array for signature
+*              - const unsigned char mu[]: byte array containing mu
+*              - const expanded_sk *esk: pointer to expanded secret key
+*              - threadpool *pool: pointer to thread pool for distributing
+*                                  the polynomial multiplications, may be NULL
+**************************************************/
+static void sign_mu(unsigned char sig[CRYPTO_BYTES],
+                    const unsigned char mu[CRHBYTES],
+                    const expanded_sk *esk,
+                    sign_scratch *s,
+                    threadpool *pool)
+{
+  unsigned int i, n;
+  unsigned char seedbuf[SEEDBYTES + 2*CRHBYTES];
+  unsigned char *rhoprime;
+  uint16_t nonce = 0;
+  poly c, chat;
+  polyvecl *y = &s->y, *yhat = &s->yhat, *z = &s->z;
+  polyveck *w = &s->w, *w1 = &s->w1, *w0 = &s->w0;
+  polyveck *h = &s->h, *cs2 = &s->cs2, *ct0 = &s->ct0;
+
+  rhoprime = seedbuf + SEEDBYTES + CRHBYTES;
+  for(i = 0; i < SEEDBYTES; ++i)
+    seedbuf[i] = esk->key[i];
+  for(i = 0; i < CRHBYTES; ++i)
+    seedbuf[SEEDBYTES + i] = mu[i];
+
+#ifdef RANDOMIZED_SIGNING
+  randombytes(rhoprime, CRHBYTES);
+#else
+  crh(rhoprime, seedbuf, SEEDBYTES + CRHBYTES);
+#endif
+
+  SIGNSTATS_BEGIN();
+
+  rej:
+  /* Sample intermediate vector y */
+#if L == 2
+  poly_uniform_gamma1m1_4x(&y->vec[0], &y->vec[1],
+                           &yhat->vec[0], &yhat->vec[1],
+                           rhoprime, nonce, nonce + 1, 0, 0);
+  nonce += 2;
+#elif L == 3
+  poly_uniform_gamma1m1_4x(&y->vec[0], &y->vec[1], &y->vec[2], &yhat->vec[0],
+                           rhoprime, nonce, nonce + 1, nonce + 2, 0);
+  nonce += 3;
+#elif L == 4
+  poly_uniform_gamma1m1_4x(&y->vec[0], &y->vec[1], &y->vec[2], &y->vec[3],
                            rhoprime, nonce, nonce + 1, nonce + 2, nonce + 3);
   nonce += 4;
 #elif L == 5
-  poly_uniform_gamma1m1_4x(&y.vec[0], &y.vec[1], &y.vec[2], &y.vec[3],
+  poly_uniform_gamma1m1_4x(&y->vec[0], &y->vec[1], &y->vec[2], &y->vec[3],
                            rhoprime, nonce, nonce + 1, nonce + 2, nonce + 3);
-  poly_uniform_gamma1m1(&y.vec[4], rhoprime, nonce + 4);
+  poly_uniform_gamma1m1(&y->vec[4], rhoprime, nonce + 4);
   nonce += 5;
 #else
 #error
 #endif
 
   /* Matrix-vector multiplication */
-  yhat = y;
-  polyvecl_ntt(&yhat);
+  *yhat = *y;
+  polyvecl_ntt(yhat);
+  matmul_parallel(w->vec, esk->mat, yhat, pool);
+
+  /* Decompose w and call the random oracle */
+  polyveck_csubq(w);
+  polyveck_decompose(w1, w0, w);
+  challenge(&c, mu, w1);
+  chat = c;
+  poly_ntt(&chat);
+
+  /* Check that subtracting cs2 does not change high bits of w and low bits
+   * do not reveal secret information */
+  polymul_parallel(cs2->vec, &chat, esk->s2.vec, K, pool);
+  polyveck_sub(w0, w0, cs2);
+  polyveck_freeze(w0);
+  if(polyveck_chknorm(w0, GAMMA2 - BETA)) {
+    SIGNSTATS_REJECT(SIGNSTATS_REJECT_W0);
+    goto rej;
+  }
+
+  /* Compute z, reject if it reveals secret */
+  polymul_parallel(z->vec, &chat, esk->s1.vec, L, pool);
+  polyvecl_add(z, z, y);
+  polyvecl_freeze(z);
+  if(polyvecl_chknorm(z, GAMMA1 - BETA)) {
+    SIGNSTATS_REJECT(SIGNSTATS_REJECT_Z);
+    goto rej;
+  }
+
+  /* Compute hints for w1 */
+  polymul_parallel(ct0->vec, &chat, esk->t0.vec, K, pool);
+
+  polyveck_csubq(ct0);
+  if(polyveck_chknorm(ct0, GAMMA2)) {
+    SIGNSTATS_REJECT(SIGNSTATS_REJECT_CT0);
+    goto rej;
+  }
+
+  polyveck_add(w0, w0, ct0);
+  polyveck_csubq(w0);
+  n = polyveck_make_hint(h, w0, w1);
+  if(n > OMEGA) {
+    SIGNSTATS_REJECT(SIGNSTATS_REJECT_HINT);
+    goto rej;
+  }
+
+  SIGNSTATS_ACCEPT();
+
+  /* Write signature */
+  pack_sig(sig, z, h, &c);
+}
+#endif
+
+/*************************************************
+* Name:        sign_expanded
+*
+* Description: Compute signed message using expanded secret key and the
+*              given scratch space for the vectors of the signing loop.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const expanded_sk *esk: pointer to expanded secret key
+*              - sign_scratch *s: pointer to scratch space
+*              - threadpool *pool: pointer to thread pool, may be NULL
+*
+* Returns 0 (success)
+**************************************************/
+static int sign_expanded(unsigned char *sm,
+                         unsigned long long *smlen,
+                         const unsigned char *m,
+                         unsigned long long mlen,
+                         const expanded_sk *esk,
+                         sign_scratch *s,
+                         threadpool *pool)
+{
+  unsigned long long i;
+  unsigned char mu[CRHBYTES];
+
+  /* Copy message into the sm buffer,
+   * backwards since m and sm can be equal in SUPERCOP API */
+  for(i = 1; i <= mlen; ++i)
+    sm[CRYPTO_BYTES + mlen - i] = m[mlen - i];
+
+  /* Compute CRH(tr, msg) */
+  compute_mu(mu, esk->tr, sm + CRYPTO_BYTES, mlen);
+
+  /* Write signature */
+  sign_mu(sm, mu, esk, s, pool);
+
+  *smlen = mlen + CRYPTO_BYTES;
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_expanded_parallel
+*
+* Description: Compute signed message using expanded secret key with the
+*              polynomial multiplications distributed over a thread pool.
+*              Output is identical to crypto_sign with the corresponding
+*              secret key.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const expanded_sk *esk: pointer to expanded secret key
+*              - threadpool *pool: pointer to thread pool, may be NULL
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_expanded_parallel(unsigned char *sm,
+                                  unsigned long long *smlen,
+                                  const unsigned char *m,
+                                  unsigned long long mlen,
+                                  const expanded_sk *esk,
+                                  threadpool *pool)
+{
+  sign_scratch s;
+
+  return sign_expanded(sm, smlen, m, mlen, esk, &s, pool);
+}
+
+/*************************************************
+* Name:        crypto_sign_expanded
+*
+* Description: Compute signed message using expanded secret key. Output is
+*              identical to crypto_sign with the corresponding secret key.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const expanded_sk *esk: pointer to expanded secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_expanded(unsigned char *sm,
+                         unsigned long long *smlen,
+                         const unsigned char *m,
+                         unsigned long long mlen,
+                         const expanded_sk *esk)
+{
+  return crypto_sign_expanded_parallel(sm, smlen, m, mlen, esk, NULL);
+}
+
+/*************************************************
+* Name:        crypto_sign_expanded_scratch
+*
+* Description: Compute signed message using expanded secret key, keeping
+*              the vectors of the signing loop in caller-provided scratch
+*              space instead of on the stack. Output is identical to
+*              crypto_sign with the corresponding secret key.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const expanded_sk *esk: pointer to expanded secret key
+*              - sign_scratch *s: pointer to scratch space, not shared with
+*                                 concurrent calls
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_expanded_scratch(unsigned char *sm,
+                                 unsigned long long *smlen,
+                                 const unsigned char *m,
+                                 unsigned long long mlen,
+                                 const expanded_sk *esk,
+                                 sign_scratch *s)
+{
+  return sign_expanded(sm, smlen, m, mlen, esk, s, NULL);
+}
+
+/*************************************************
+* Name:        crypto_sign
+*
+* Description: Compute signed message.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign(unsigned char *sm,
+                unsigned long long *smlen,
+                const unsigned char *m,
+                unsigned long long mlen,
+                const unsigned char *sk)
+{
+  expanded_sk esk;
+
+  crypto_sign_sk_expand(&esk, sk);
+  return crypto_sign_expanded(sm, smlen, m, mlen, &esk);
+}
+
+/*************************************************
+* Name:        crypto_sign_parallel
+*
+* Description: Compute signed message with key expansion and polynomial
+*              multiplications distributed over a thread pool. Output is
+*              identical to crypto_sign.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*              - threadpool *pool: pointer to thread pool, may be NULL
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_parallel(unsigned char *sm,
+                         unsigned long long *smlen,
+                         const unsigned char *m,
+                         unsigned long long mlen,
+                         const unsigned char *sk,
+                         threadpool *pool)
+{
+  expanded_sk esk;
+
+  crypto_sign_sk_expand_parallel(&esk, sk, pool);
+  return crypto_sign_expanded_parallel(sm, smlen, m, mlen, &esk, pool);
+}
+
+/*************************************************
+* Name:        crypto_sign_signature
+*
+* Description: Compute detached signature. Message is hashed in place, so
+*              no copy of it is made.
+*
+* Arguments:   - unsigned char *sig: pointer to output signature (of length
+*                                    CRYPTO_BYTES)
+*              - unsigned long long *siglen: pointer to output length of
+*                                            signature
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_signature(unsigned char *sig,
+                          unsigned long long *siglen,
+                          const unsigned char *m,
+                          unsigned long long mlen,
+                          const unsigned char *sk)
+{
+  unsigned char mu[CRHBYTES];
+  expanded_sk esk;
+  sign_scratch s;
+
+  crypto_sign_sk_expand(&esk, sk);
+  compute_mu(mu, esk.tr, m, mlen);
+  sign_mu(sig, mu, &esk, &s, NULL);
+
+  *siglen = CRYPTO_BYTES;
+  return 0;
+}
+
+/*************************************************
+* Name:        sign_mu_lowmem
+*
+* Description: Compute signature of message representative mu directly from
+*              the bit-packed secret key, keeping only w and a few single
+*              polynomials in memory. A and y are sampled anew in every
+*              iteration of the rejection loop; y, s1, s2 and t0 are
+*              sampled or unpacked one polynomial at a time, and z, h and c
+*              are written to the signature as soon as they are known.
+*              Output is identical to sign_mu.
+*
+* Arguments:   - unsigned char sig[]: output byte array for signature
+*              - const unsigned char mu[]: byte array containing mu
+*              - const unsigned char *sk: pointer to bit-packed secret key
+**************************************************/
+static void sign_mu_lowmem(unsigned char sig[CRYPTO_BYTES],
+                           const unsigned char mu[CRHBYTES],
+                           const unsigned char *sk)
+{
+  unsigned int i, j, n;
+  unsigned char seedbuf[SEEDBYTES + 2*CRHBYTES];
+  unsigned char w1buf[K*POLW1_SIZE_PACKED];
+  unsigned char *rhoprime;
+  uint16_t nonce = 0;
+  poly c, chat, a, t;
+  polyveck w;
+  keccak_state state;
+
+  rhoprime = seedbuf + SEEDBYTES + CRHBYTES;
+  for(i = 0; i < SEEDBYTES; ++i)
+    seedbuf[i] = sk[SEEDBYTES + i];
+  for(i = 0; i < CRHBYTES; ++i)
+    seedbuf[SEEDBYTES + i] = mu[i];
+
+#ifdef RANDOMIZED_SIGNING
+  randombytes(rhoprime, CRHBYTES);
+#else
+  crh(rhoprime, seedbuf, SEEDBYTES + CRHBYTES);
+#endif
+
+  SIGNSTATS_BEGIN();
+
+  rej:
+  /* Matrix-vector multiplication column by column; sk starts with rho */
+  for(j = 0; j < L; ++j) {
+    poly_uniform_gamma1m1(&t, rhoprime, nonce++);
+    poly_ntt(&t);
+    for(i = 0; i < K; ++i) {
+      poly_uniform(&a, sk, (i << 8) + j);
+      if(j == 0)
+        poly_pointwise_invmontgomery(&w.vec[i], &a, &t);
+      else {
+        poly_pointwise_invmontgomery(&a, &a, &t);
+        poly_add(&w.vec[i], &w.vec[i], &a);
+      }
+    }
+  }
+
+  /* Decompose w, keeping w0 in place, and call the random oracle */
+  shake256_inc_init(&state);
+  shake256_inc_absorb(&state, mu, CRHBYTES);
   for(i = 0; i < K; ++i) {
-    polyvecl_pointwise_acc_invmontgomery(&w.vec[i], &mat[i], &yhat);
-    //poly_reduce(&w.vec[i]);
+    poly_reduce(&w.vec[i]);
     poly_invntt_montgomery(&w.vec[i]);
+    poly_csubq(&w.vec[i]);
+    poly_decompose(&a, &t, &w.vec[i]);
+    w.vec[i] = t;
+    polyw1_pack(w1buf + i*POLW1_SIZE_PACKED, &a);
   }
+  shake256_inc_absorb(&state, w1buf, sizeof(w1buf));
+  shake256_inc_finalize(&state);
+  challenge_sample(&c, &state);
+  chat = c;
+  poly_ntt(&chat);
+
+  /* Check that subtracting cs2 does not change high bits of w and low bits
+   * do not reveal secret information */
+  for(i = 0; i < K; ++i) {
+    unpack_sk_s2(&t, i, sk);
+    poly_ntt(&t);
+    poly_pointwise_invmontgomery(&t, &chat, &t);
+    poly_invntt_montgomery(&t);
+    poly_sub(&w.vec[i], &w.vec[i], &t);
+    poly_freeze(&w.vec[i]);
+    if(poly_chknorm(&w.vec[i], GAMMA2 - BETA)) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_W0);
+      goto rej;
+    }
+  }
+
+  /* Compute z with y sampled again, reject if it reveals secret */
+  for(j = 0; j < L; ++j) {
+    unpack_sk_s1(&t, j, sk);
+    poly_ntt(&t);
+    poly_pointwise_invmontgomery(&t, &chat, &t);
+    poly_invntt_montgomery(&t);
+    poly_uniform_gamma1m1(&a, rhoprime, nonce - L + j);
+    poly_add(&t, &t, &a);
+    poly_freeze(&t);
+    if(poly_chknorm(&t, GAMMA1 - BETA)) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_Z);
+      goto rej;
+    }
+    pack_sig_z(sig, &t, j);
+  }
+
+  /* Compute hints for w1 */
+  n = 0;
+  for(i = 0; i < K; ++i) {
+    unpack_sk_t0(&t, i, sk);
+    poly_ntt(&t);
+    poly_pointwise_invmontgomery(&t, &chat, &t);
+    poly_invntt_montgomery(&t);
+    poly_csubq(&t);
+    if(poly_chknorm(&t, GAMMA2)) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_CT0);
+      goto rej;
+    }
+
+    poly_add(&w.vec[i], &w.vec[i], &t);
+    poly_csubq(&w.vec[i]);
+    polyw1_unpack(&a, w1buf + i*POLW1_SIZE_PACKED);
+    poly_make_hint(&t, &w.vec[i], &a);
+    n = pack_sig_hint(sig, &t, i, n);
+    if(n > OMEGA) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_HINT);
+      goto rej;
+    }
+  }
+
+  SIGNSTATS_ACCEPT();
+
+  /* Write challenge */
+  pack_sig_c(sig, &c);
+}
+
+/*************************************************
+* Name:        crypto_sign_lowmem
+*
+* Description: Compute signed message like crypto_sign, but without
+*              expanding the secret key. Every iteration of the rejection
+*              loop samples A and y again and unpacks s1, s2 and t0 one
+*              polynomial at a time. This makes signing two to three times
+*              slower in exchange for a peak stack usage including callees
+*              of about 9.9, 11.0, 12.2 and 13.3 KiB for modes 1 to 4,
+*              while the frames of crypto_sign and sign_mu alone take 42,
+*              60, 80 and 102 KiB (GCC 12, -O3). Output is identical to
+*              crypto_sign.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_lowmem(unsigned char *sm,
+                       unsigned long long *smlen,
+                       const unsigned char *m,
+                       unsigned long long mlen,
+                       const unsigned char *sk)
+{
+  unsigned long long i;
+  unsigned char mu[CRHBYTES];
+
+  /* Copy message into the sm buffer,
+   * backwards since m and sm can be equal in SUPERCOP API */
+  for(i = 1; i <= mlen; ++i)
+    sm[CRYPTO_BYTES + mlen - i] = m[mlen - i];
+
+  /* Compute CRH(tr, msg) */
+  compute_mu(mu, sk + 2*SEEDBYTES, sm + CRYPTO_BYTES, mlen);
+
+  /* Write signature */
+  sign_mu_lowmem(sm, mu, sk);
+
+  *smlen = mlen + CRYPTO_BYTES;
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_signature_lowmem
+*
+* Description: Compute detached signature with the stack usage of
+*              crypto_sign_lowmem.
+*
+* Arguments:   - unsigned char *sig: pointer to output signature (allocated
+*                                    array of CRYPTO_BYTES bytes)
+*              - unsigned long long *siglen: pointer to output length of
+*                                            signature
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_signature_lowmem(unsigned char *sig,
+                                 unsigned long long *siglen,
+                                 const unsigned char *m,
+                                 unsigned long long mlen,
+                                 const unsigned char *sk)
+{
+  unsigned char mu[CRHBYTES];
+
+  compute_mu(mu, sk + 2*SEEDBYTES, m, mlen);
+  sign_mu_lowmem(sig, mu, sk);
+
+  *siglen = CRYPTO_BYTES;
+  return 0;
+}
+
+/*************************************************
+* Name:        expand_pk_polys
+*
+* Description: Unpack public key and precompute matrix A and NTT(2^D*t1).
+*              Leaves tr untouched.
+*
+* Arguments:   - expanded_pk *epk: pointer to output expanded public key
+*              - const unsigned char *pk: pointer to bit-packed public key
+**************************************************/
+static void expand_pk_polys(expanded_pk *epk, const unsigned char *pk) {
+  unsigned char rho[SEEDBYTES];
+
+  unpack_pk(rho, &epk->t1, pk);
+  matcache_expand_mat(epk->mat, rho);
+  polyveck_shiftl(&epk->t1);
+  polyveck_ntt(&epk->t1);
+}
+
+/*************************************************
+* Name:        verify_w1
+*
+* Description: Unpack and norm-check signature and reconstruct w1 from it,
+*              i.e. everything in verification that does not depend on the
+*              message.
+*
+* Arguments:   - polyveck *w1: pointer to output vector w1
+*              - poly *c: pointer to output challenge polynomial from sig
+*              - const unsigned char *sig: pointer to signature
+*              - const expanded_pk *epk: pointer to expanded public key
+*
+* Returns 0 if signature is well-formed and -1 otherwise
+**************************************************/
+static int verify_w1(polyveck *w1,
+                     poly *c,
+                     const unsigned char *sig,
+                     const expanded_pk *epk)
+{
+  unsigned int i;
+  poly chat;
+  polyvecl z;
+  polyveck h, tmp1, tmp2;
+
+  if(unpack_sig(&z, &h, c, sig))
+    return -1;
+  if(polyvecl_chknorm(&z, GAMMA1 - BETA))
+    return -1;
+
+  /* Matrix-vector multiplication; compute Az - c2^dt1 */
+  polyvecl_ntt(&z);
+  for(i = 0; i < K ; ++i)
+    polyvecl_pointwise_acc_invmontgomery(&tmp1.vec[i], &epk->mat[i], &z);
+
+  chat = *c;
+  poly_ntt(&chat);
+  for(i = 0; i < K; ++i)
+    poly_pointwise_invmontgomery(&tmp2.vec[i], &chat, &epk->t1.vec[i]);
+
+  polyveck_sub(&tmp1, &tmp1, &tmp2);
+  polyveck_reduce(&tmp1);
+  polyveck_invntt_montgomery(&tmp1);
+
+  /* Reconstruct w1 */
+  polyveck_csubq(&tmp1);
+  polyveck_use_hint(w1, &tmp1, &h);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        verify_mu
+*
+* Description: Verify signature on message representative mu.
+*
+* Arguments:   - const unsigned char *sig: pointer to signature
+*              - const unsigned char mu[]: byte array containing mu
+*              - const expanded_pk *epk: pointer to expanded public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+static int verify_mu(const unsigned char *sig,
+                     const unsigned char mu[CRHBYTES],
+                     const expanded_pk *epk)
+{
+  unsigned int i;
+  poly c, cp;
+  polyveck w1;
+
+  if(verify_w1(&w1, &c, sig, epk))
+    return -1;
+
+  /* Call random oracle and verify challenge */
+  challenge(&cp, mu, &w1);
+  for(i = 0; i < N; ++i)
+    if(c.coeffs[i] != cp.coeffs[i])
+      return -1;
+
+  return 0;
+}
 
-  /* Decompose w and call the random oracle */
-  polyveck_csubq(&w);
-  polyveck_decompose(&w1, &w0, &w);
-  challenge(&c, mu, &w1);
-  chat = c;
-  poly_ntt(&chat);
+/*************************************************
+* Name:        crypto_sign_pk_expand
+*
+* Description: Precompute all message-independent parts of verification for
+*              a public key, i.e. the matrix A, NTT(2^D*t1) and tr = CRH(pk).
+*              See sign.h for the size of the expanded key.
+*
+* Arguments:   - expanded_pk *epk: pointer to output expanded public key
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_pk_expand(expanded_pk *epk, const unsigned char *pk) {
+  expand_pk_polys(epk, pk);
+  crh(epk->tr, pk, CRYPTO_PUBLICKEYBYTES);
 
-  /* Check that subtracting cs2 does not change high bits of w and low bits
-   * do not reveal secret information */
-  for(i = 0; i < K; ++i) {
-    poly_pointwise_invmontgomery(&cs2.vec[i], &chat, &s2.vec[i]);
-    poly_invntt_montgomery(&cs2.vec[i]);
-  }
-  polyveck_sub(&w0, &w0, &cs2);
-  polyveck_freeze(&w0);
-  if(polyveck_chknorm(&w0, GAMMA2 - BETA))
-    goto rej;
+  return 0;
+}
 
-  /* Compute z, reject if it reveals secret */
-  for(i = 0; i < L; ++i) {
-    poly_pointwise_invmontgomery(&z.vec[i], &chat, &s1.vec[i]);
-    poly_invntt_montgomery(&z.vec[i]);
-  }
-  polyvecl_add(&z, &z, &y);
-  polyvecl_freeze(&z);
-  if(polyvecl_chknorm(&z, GAMMA1 - BETA))
-    goto rej;
+/*************************************************
+* Name:        crypto_sign_open_expanded
+*
+* Description: Verify signed message using expanded public key.
+*
+* Arguments:   - unsigned char *m: pointer to output message (allocated
+*                                  array with smlen bytes), can be equal to sm
+*              - unsigned long long *mlen: pointer to output length of message
+*              - const unsigned char *sm: pointer to signed message
+*              - unsigned long long smlen: length of signed message
+*              - const expanded_pk *epk: pointer to expanded public key
+*
+* Returns 0 if signed message could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_open_expanded(unsigned char *m,
+                              unsigned long long *mlen,
+                              const unsigned char *sm,
+                              unsigned long long smlen,
+                              const expanded_pk *epk)
+{
+  unsigned long long i;
+  unsigned char mu[CRHBYTES];
 
-  /* Compute hints for w1 */
-  for(i = 0; i < K; ++i) {
-    poly_pointwise_invmontgomery(&ct0.vec[i], &chat, &t0.vec[i]);
-    poly_invntt_montgomery(&ct0.vec[i]);
-  }
+  if(smlen < CRYPTO_BYTES)
+    goto badsig;
 
-  polyveck_csubq(&ct0);
-  if(polyveck_chknorm(&ct0, GAMMA2))
-    goto rej;
+  *mlen = smlen - CRYPTO_BYTES;
 
-  polyveck_add(&w0, &w0, &ct0);
-  polyveck_csubq(&w0);
-  n = polyveck_make_hint(&h, &w0, &w1);
-  if(n > OMEGA)
-    goto rej;
+  /* Compute CRH(CRH(rho, t1), msg) */
+  compute_mu(mu, epk->tr, sm + CRYPTO_BYTES, *mlen);
 
-  /* Write signature */
-  pack_sig(sm, &z, &h, &c);
+  if(verify_mu(sm, mu, epk))
+    goto badsig;
+
+  /* All good, copy msg, return 0 */
+  for(i = 0; i < *mlen; ++i)
+    m[i] = sm[CRYPTO_BYTES + i];
 
-  *smlen = mlen + CRYPTO_BYTES;
   return 0;
+
+  /* Signature verification failed */
+  badsig:
+  *mlen = (unsigned long long) -1;
+  for(i = 0; i < smlen; ++i)
+    m[i] = 0;
+
+  return -1;
 }
 
 /*************************************************
@@ -454,57 +1486,164 @@ int crypto_sign_open(unsigned char *m,
                      const unsigned char *pk)
 {
   unsigned long long i;
-  unsigned char rho[SEEDBYTES];
-  unsigned char mu[CRHBYTES];
-  poly c, chat, cp;
-  polyvecl mat[K], z;
-  polyveck t1, w1, h, tmp1, tmp2;
+  expanded_pk epk;
 
-  if(smlen < CRYPTO_BYTES)
-    goto badsig;
+  /* Reject truncated input before paying for the key expansion */
+  if(smlen < CRYPTO_BYTES) {
+    *mlen = (unsigned long long) -1;
+    for(i = 0; i < smlen; ++i)
+      m[i] = 0;
+    return -1;
+  }
 
-  *mlen = smlen - CRYPTO_BYTES;
+  crypto_sign_pk_expand(&epk, pk);
+  return crypto_sign_open_expanded(m, mlen, sm, smlen, &epk);
+}
 
-  unpack_pk(rho, &t1, pk);
-  if(unpack_sig(&z, &h, &c, sm))
-    goto badsig;
-  if(polyvecl_chknorm(&z, GAMMA1 - BETA))
-    goto badsig;
+/*************************************************
+* Name:        crypto_sign_verify
+*
+* Description: Verify detached signature. Message is hashed in place, so
+*              no copy of it is made.
+*
+* Arguments:   - const unsigned char *sig: pointer to signature
+*              - unsigned long long siglen: length of signature
+*              - const unsigned char *m: pointer to message
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify(const unsigned char *sig,
+                       unsigned long long siglen,
+                       const unsigned char *m,
+                       unsigned long long mlen,
+                       const unsigned char *pk)
+{
+  unsigned char mu[CRHBYTES];
+  expanded_pk epk;
 
-  /* Compute CRH(CRH(rho, t1), msg) using m as "playground" buffer */
-  if(sm != m)
-    for(i = 0; i < *mlen; ++i)
-      m[CRYPTO_BYTES + i] = sm[CRYPTO_BYTES + i];
+  if(siglen != CRYPTO_BYTES)
+    return -1;
 
-  crh(m + CRYPTO_BYTES - CRHBYTES, pk, CRYPTO_PUBLICKEYBYTES);
-  crh(mu, m + CRYPTO_BYTES - CRHBYTES, CRHBYTES + *mlen);
+  crypto_sign_pk_expand(&epk, pk);
+  compute_mu(mu, epk.tr, m, mlen);
+  return verify_mu(sig, mu, &epk);
+}
 
-  /* Matrix-vector multiplication; compute Az - c2^dt1 */
-  expand_mat(mat, rho);
-  polyvecl_ntt(&z);
-  for(i = 0; i < K ; ++i)
-    polyvecl_pointwise_acc_invmontgomery(&tmp1.vec[i], &mat[i], &z);
+/*************************************************
+* Name:        verify_mu_lowmem
+*
+* Description: Verify signature on message representative mu without
+*              storing A, t1 or h. Every polynomial of A is generated and
+*              multiplied into its row of Az right away, and each row of w1
+*              is absorbed into the challenge hash as soon as it is known.
+*
+* Arguments:   - const unsigned char *sig: pointer to signature
+*              - const unsigned char mu[]: byte array containing mu
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+static int verify_mu_lowmem(const unsigned char *sig,
+                            const unsigned char mu[CRHBYTES],
+                            const unsigned char *pk)
+{
+  unsigned int i, j;
+  unsigned char buf[POLW1_SIZE_PACKED];
+  poly c, chat, a, w, t;
+  polyvecl z;
+  keccak_state state;
 
+  if(unpack_sig_zc(&z, &c, sig))
+    return -1;
+  if(polyvecl_chknorm(&z, GAMMA1 - BETA))
+    return -1;
+
+  polyvecl_ntt(&z);
   chat = c;
   poly_ntt(&chat);
-  polyveck_shiftl(&t1);
-  polyveck_ntt(&t1);
-  for(i = 0; i < K; ++i)
-    poly_pointwise_invmontgomery(&tmp2.vec[i], &chat, &t1.vec[i]);
 
-  polyveck_sub(&tmp1, &tmp1, &tmp2);
-  polyveck_reduce(&tmp1);
-  polyveck_invntt_montgomery(&tmp1);
+  shake256_inc_init(&state);
+  shake256_inc_absorb(&state, mu, CRHBYTES);
 
-  /* Reconstruct w1 */
-  polyveck_csubq(&tmp1);
-  polyveck_use_hint(&w1, &tmp1, &h);
+  for(i = 0; i < K; ++i) {
+    /* Row i of Az; pk starts with rho */
+    poly_uniform(&a, pk, (i << 8));
+    poly_pointwise_invmontgomery(&w, &a, &z.vec[0]);
+    for(j = 1; j < L; ++j) {
+      poly_uniform(&a, pk, (i << 8) + j);
+      poly_pointwise_invmontgomery(&a, &a, &z.vec[j]);
+      poly_add(&w, &w, &a);
+    }
+
+    /* Subtract c2^dt1 */
+    polyt1_unpack(&t, pk + SEEDBYTES + i*POLT1_SIZE_PACKED);
+    poly_shiftl(&t);
+    poly_ntt(&t);
+    poly_pointwise_invmontgomery(&t, &chat, &t);
+    poly_sub(&w, &w, &t);
+    poly_reduce(&w);
+    poly_invntt_montgomery(&w);
+
+    /* Reconstruct row i of w1 and absorb it */
+    poly_csubq(&w);
+    unpack_sig_hint(&t, i, sig);
+    poly_use_hint(&a, &w, &t);
+    polyw1_pack(buf, &a);
+    shake256_inc_absorb(&state, buf, POLW1_SIZE_PACKED);
+  }
 
   /* Call random oracle and verify challenge */
-  challenge(&cp, mu, &w1);
+  shake256_inc_finalize(&state);
+  challenge_sample(&a, &state);
   for(i = 0; i < N; ++i)
-    if(c.coeffs[i] != cp.coeffs[i])
-      goto badsig;
+    if(c.coeffs[i] != a.coeffs[i])
+      return -1;
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_open_lowmem
+*
+* Description: Verify signed message like crypto_sign_open, but without
+*              expanding the public key. Neither A nor any full vector of
+*              length K is kept in memory. Peak stack usage including callees
+*              is about 9.5, 10.5, 11.5 and 12.5 KiB for modes 1 to 4, while
+*              the frame of crypto_sign_open alone takes 15, 23, 33 and 46
+*              KiB (GCC 12, -O3). A is generated anew on every call.
+*
+* Arguments:   - unsigned char *m: pointer to output message (allocated
+*                                  array with smlen bytes), can be equal to sm
+*              - unsigned long long *mlen: pointer to output length of message
+*              - const unsigned char *sm: pointer to signed message
+*              - unsigned long long smlen: length of signed message
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 if signed message could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_open_lowmem(unsigned char *m,
+                            unsigned long long *mlen,
+                            const unsigned char *sm,
+                            unsigned long long smlen,
+                            const unsigned char *pk)
+{
+  unsigned long long i;
+  unsigned char tr[CRHBYTES];
+  unsigned char mu[CRHBYTES];
+
+  if(smlen < CRYPTO_BYTES)
+    goto badsig;
+
+  *mlen = smlen - CRYPTO_BYTES;
+
+  /* Compute CRH(CRH(rho, t1), msg) */
+  crh(tr, pk, CRYPTO_PUBLICKEYBYTES);
+  compute_mu(mu, tr, sm + CRYPTO_BYTES, *mlen);
+
+  if(verify_mu_lowmem(sm, mu, pk))
+    goto badsig;
 
   /* All good, copy msg, return 0 */
   for(i = 0; i < *mlen; ++i)
@@ -520,3 +1659,320 @@ int crypto_sign_open(unsigned char *m,
 
   return -1;
 }
+
+/*************************************************
+* Name:        crypto_sign_verify_lowmem
+*
+* Description: Verify detached signature with the stack usage of
+*              crypto_sign_open_lowmem.
+*
+* Arguments:   - const unsigned char *sig: pointer to signature
+*              - unsigned long long siglen: length of signature
+*              - const unsigned char *m: pointer to message
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify_lowmem(const unsigned char *sig,
+                              unsigned long long siglen,
+                              const unsigned char *m,
+                              unsigned long long mlen,
+                              const unsigned char *pk)
+{
+  unsigned char tr[CRHBYTES];
+  unsigned char mu[CRHBYTES];
+
+  if(siglen != CRYPTO_BYTES)
+    return -1;
+
+  crh(tr, pk, CRYPTO_PUBLICKEYBYTES);
+  compute_mu(mu, tr, m, mlen);
+  return verify_mu_lowmem(sig, mu, pk);
+}
+
+/*************************************************
+* Name:        crypto_sign_open_batch
+*
+* Description: Verify n signed messages under possibly different public keys.
+*              The SHAKE256 work (tr and mu hashing and the challenge) of
+*              four signatures at a time is computed in the four lanes of
+*              the AVX2 Keccak implementation. Output buffers behave exactly
+*              as for crypto_sign_open.
+*
+* Arguments:   - unsigned long long n: number of signed messages
+*              - const unsigned char *pk[]: array of pointers to public keys
+*              - const unsigned char *sm[]: array of pointers to signed
+*                                           messages
+*              - const unsigned long long smlen[]: array of lengths of signed
+*                                                  messages
+*              - unsigned char *m[]: array of pointers to output messages
+*                                    (allocated arrays with smlen[i] bytes),
+*                                    m[i] can be equal to sm[i]
+*              - unsigned long long mlen[]: array of output message lengths
+*              - int results[]: array of per-signature results, 0 if signed
+*                               message could be verified correctly and -1
+*                               otherwise
+*
+* Returns 0 if all signed messages could be verified and -1 otherwise
+**************************************************/
+#ifdef USE_AES
+int crypto_sign_open_batch(unsigned long long n,
+                           const unsigned char *pk[],
+                           const unsigned char *sm[],
+                           const unsigned long long smlen[],
+                           unsigned char *m[],
+                           unsigned long long mlen[],
+                           int results[])
+{
+  unsigned long long i;
+  int ret = 0;
+
+  for(i = 0; i < n; ++i) {
+    results[i] = crypto_sign_open(m[i], &mlen[i], sm[i], smlen[i], pk[i]);
+    ret |= results[i];
+  }
+
+  return ret;
+}
+#else
+int crypto_sign_open_batch(unsigned long long n,
+                           const unsigned char *pk[],
+                           const unsigned char *sm[],
+                           const unsigned long long smlen[],
+                           unsigned char *m[],
+                           unsigned long long mlen[],
+                           int results[])
+{
+  unsigned int j, k;
+  unsigned long long i, l, idx[4], inlen[4];
+  int ret = 0, good[4];
+  unsigned char dummy[CRHBYTES];
+  unsigned char mu[4][CRHBYTES];
+  unsigned char *buf[4];
+  poly c[4], cp[4];
+  polyveck w1[4];
+  expanded_pk epk;
+
+  for(i = 0; i < n; i += 4) {
+    for(j = 0; j < 4; ++j) {
+      /* Unused lanes of the last group repeat the first signature */
+      if(i + j >= n) {
+        idx[j] = i;
+        good[j] = good[0];
+        inlen[j] = inlen[0];
+        buf[j] = buf[0];
+        c[j] = c[0];
+        w1[j] = w1[0];
+        continue;
+      }
+
+      /* Reconstruct w1 of each signature */
+      idx[j] = i + j;
+      good[j] = 0;
+      if(smlen[i + j] >= CRYPTO_BYTES) {
+        expand_pk_polys(&epk, pk[i + j]);
+        good[j] = !verify_w1(&w1[j], &c[j], sm[i + j], &epk);
+      }
+
+      if(good[j]) {
+        inlen[j] = smlen[i + j] - CRYPTO_BYTES;
+        buf[j] = m[i + j] + CRYPTO_BYTES - CRHBYTES;
+        if(sm[i + j] != m[i + j])
+          for(l = 0; l < inlen[j]; ++l)
+            buf[j][CRHBYTES + l] = sm[i + j][CRYPTO_BYTES + l];
+      }
+      else {
+        /* Lane is still hashed but its output is discarded */
+        inlen[j] = 0;
+        buf[j] = dummy;
+      }
+    }
+
+    /* Compute CRH(CRH(rho, t1), msg) in 4 lanes, m is playground again */
+    shake256_4x(buf[0], buf[1], buf[2], buf[3], CRHBYTES,
+                pk[idx[0]], pk[idx[1]], pk[idx[2]], pk[idx[3]],
+                CRYPTO_PUBLICKEYBYTES);
+    shake256_4x_varlen(mu[0], mu[1], mu[2], mu[3], CRHBYTES,
+                       buf[0], buf[1], buf[2], buf[3],
+                       CRHBYTES + inlen[0], CRHBYTES + inlen[1],
+                       CRHBYTES + inlen[2], CRHBYTES + inlen[3]);
+
+    /* Call random oracle in 4 lanes and verify challenges */
+    challenge_4x(&cp[0], &cp[1], &cp[2], &cp[3],
+                 mu[0], mu[1], mu[2], mu[3],
+                 &w1[0], &w1[1], &w1[2], &w1[3]);
+
+    for(j = 0; j < 4 && i + j < n; ++j) {
+      for(k = 0; k < N; ++k)
+        if(c[j].coeffs[k] != cp[j].coeffs[k])
+          good[j] = 0;
+
+      if(good[j]) {
+        mlen[i + j] = inlen[j];
+        for(l = 0; l < inlen[j]; ++l)
+          m[i + j][l] = sm[i + j][CRYPTO_BYTES + l];
+        results[i + j] = 0;
+      }
+      else {
+        mlen[i + j] = (unsigned long long) -1;
+        for(l = 0; l < smlen[i + j]; ++l)
+          m[i + j][l] = 0;
+        results[i + j] = -1;
+        ret = -1;
+      }
+    }
+  }
+
+  return ret;
+}
+#endif
+
+/*************************************************
+* Name:        crypto_sign_init
+*
+* Description: Start incremental signing of a message that is passed to
+*              crypto_sign_update in pieces. The signature output by
+*              crypto_sign_final is identical to the first CRYPTO_BYTES
+*              bytes of the signed message produced by crypto_sign.
+*
+* Arguments:   - sign_state *state: pointer to output state
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_init(sign_state *state, const unsigned char *sk) {
+  shake256_inc_init(&state->mu);
+  shake256_inc_absorb(&state->mu, sk + 2*SEEDBYTES, CRHBYTES);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_update
+*
+* Description: Absorb next piece of message to be signed.
+*
+* Arguments:   - sign_state *state: pointer to state
+*              - const unsigned char *m: pointer to message piece
+*              - unsigned long long mlen: length of message piece
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_update(sign_state *state,
+                       const unsigned char *m,
+                       unsigned long long mlen)
+{
+  shake256_inc_absorb(&state->mu, m, mlen);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_final
+*
+* Description: Compute signature of all message pieces absorbed into state.
+*              The state must not be used afterwards without calling
+*              crypto_sign_init again.
+*
+* Arguments:   - unsigned char *sig: pointer to output signature (of length
+*                                    CRYPTO_BYTES)
+*              - unsigned long long *siglen: pointer to output length of
+*                                            signature
+*              - sign_state *state: pointer to state
+*              - const unsigned char *sk: pointer to bit-packed secret key,
+*                                         must match crypto_sign_init
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_final(unsigned char *sig,
+                      unsigned long long *siglen,
+                      sign_state *state,
+                      const unsigned char *sk)
+{
+  unsigned char mu[CRHBYTES];
+  expanded_sk esk;
+  sign_scratch s;
+
+  shake256_inc_finalize(&state->mu);
+  shake256_inc_squeeze(mu, CRHBYTES, &state->mu);
+
+  crypto_sign_sk_expand(&esk, sk);
+  sign_mu(sig, mu, &esk, &s, NULL);
+
+  *siglen = CRYPTO_BYTES;
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_init
+*
+* Description: Start incremental verification of a message that is passed
+*              to crypto_sign_verify_update in pieces.
+*
+* Arguments:   - sign_state *state: pointer to output state
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_verify_init(sign_state *state, const unsigned char *pk) {
+  unsigned char tr[CRHBYTES];
+
+  crh(tr, pk, CRYPTO_PUBLICKEYBYTES);
+  shake256_inc_init(&state->mu);
+  shake256_inc_absorb(&state->mu, tr, CRHBYTES);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_update
+*
+* Description: Absorb next piece of message to be verified.
+*
+* Arguments:   - sign_state *state: pointer to state
+*              - const unsigned char *m: pointer to message piece
+*              - unsigned long long mlen: length of message piece
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_verify_update(sign_state *state,
+                              const unsigned char *m,
+                              unsigned long long mlen)
+{
+  shake256_inc_absorb(&state->mu, m, mlen);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_final
+*
+* Description: Verify signature on all message pieces absorbed into state.
+*
+* Arguments:   - sign_state *state: pointer to state
+*              - const unsigned char *sig: pointer to signature
+*              - unsigned long long siglen: length of signature
+*              - const unsigned char *pk: pointer to bit-packed public key,
+*                                         must match crypto_sign_verify_init
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify_final(sign_state *state,
+                             const unsigned char *sig,
+                             unsigned long long siglen,
+                             const unsigned char *pk)
+{
+  unsigned char mu[CRHBYTES];
+  expanded_pk epk;
+
+  shake256_inc_finalize(&state->mu);
+  shake256_inc_squeeze(mu, CRHBYTES, &state->mu);
+
+  if(siglen != CRYPTO_BYTES)
+    return -1;
+
+  /* tr was already absorbed in crypto_sign_verify_init */
+  expand_pk_polys(&epk, pk);
+  return verify_mu(sig, mu, &epk);
+}
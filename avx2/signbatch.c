@@ -0,0 +1 @@
+../ref/signbatch.c
\ No newline at end of file
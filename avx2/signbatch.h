@@ -0,0 +1 @@
+../ref/signbatch.h
\ No newline at end of file
@@ -0,0 +1 @@
+../ref/signstats.c
\ No newline at end of file
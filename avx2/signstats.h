@@ -0,0 +1 @@
+../ref/signstats.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../ref/test/bench_throughput.c
\ No newline at end of file
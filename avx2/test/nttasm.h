@@ -0,0 +1,27 @@
+#ifndef NTTASM_H
+#define NTTASM_H
+
+#include <stdint.h>
+#include "../params.h"
+
+/* Assembly NTT kernels staging through 64-bit lanes, superseded by the
+ * in-place 32-bit NTT and only built into bench_kernels for comparison */
+
+extern const uint32_t zetas[N];
+extern const uint32_t zetas_inv[N];
+
+void ntt_levels0t2_avx(uint64_t tmp[N],
+                       const uint32_t a[N],
+                       const uint32_t zetas[7]);
+void ntt_levels3t8_avx(uint32_t a[N],
+                       const uint64_t tmp[N],
+                       const uint32_t zetas[31]);
+
+void invntt_levels0t4_avx(uint64_t tmp[N],
+                          const uint32_t a[N],
+                          const uint32_t zetas_inv[31]);
+void invntt_levels5t7_avx(uint32_t a[N],
+                          const uint64_t tmp[N],
+                          const uint32_t zetas_inv[7]);
+
+#endif
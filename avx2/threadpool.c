@@ -0,0 +1 @@
+../ref/threadpool.c
\ No newline at end of file
@@ -0,0 +1 @@
+../ref/threadpool.h
\ No newline at end of file
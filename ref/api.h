@@ -55,8 +55,16 @@ int crypto_sign(unsigned char *sm, unsigned long long *smlen,
                 const unsigned char *msg, unsigned long long len,
                 const unsigned char *sk);
 
+int crypto_sign_signature(unsigned char *sig, unsigned long long *siglen,
+                          const unsigned char *m, unsigned long long mlen,
+                          const unsigned char *sk);
+
 int crypto_sign_open(unsigned char *m, unsigned long long *mlen,
                      const unsigned char *sm, unsigned long long smlen,
                      const unsigned char *pk);
 
+int crypto_sign_verify(const unsigned char *sig, unsigned long long siglen,
+                       const unsigned char *m, unsigned long long mlen,
+                       const unsigned char *pk);
+
 #endif
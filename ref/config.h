@@ -7,8 +7,10 @@
 
 //#define USE_AES
 //#define RANDOMIZED_SIGNING
+//#define SPECULATIVE_SIGNING
 //#define USE_RDPMC
 //#define SERIALIZE_RDC
 //#define DBENCH
+//#define SIGN_STATS
 
 #endif
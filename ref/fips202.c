@@ -433,6 +433,127 @@ static void keccak_squeezeblocks(unsigned char *h,
   DBENCH_STOP(*tshake);
 }
 
+/*************************************************
+* Name:        keccak_inc_init
+*
+* Description: Initializes the Keccak state for incremental absorbing.
+*
+* Arguments:   - uint64_t *s: pointer to output Keccak state
+*              - unsigned int *pos: pointer to output position in block
+**************************************************/
+static void keccak_inc_init(uint64_t *s, unsigned int *pos) {
+  unsigned int i;
+
+  for(i = 0; i < 25; ++i)
+    s[i] = 0;
+  *pos = 0;
+}
+
+/*************************************************
+* Name:        keccak_inc_absorb
+*
+* Description: Incremental absorb step of Keccak. Accepts inputs of arbitrary
+*              length, partial blocks are kept XORed into the state until
+*              they are completed by subsequent calls.
+*
+* Arguments:   - uint64_t *s: pointer to input/output Keccak state
+*              - unsigned int *pos: pointer to input/output position in block
+*              - unsigned int r: rate in bytes (e.g., 168 for SHAKE128)
+*              - const unsigned char *m: pointer to input to be absorbed into s
+*              - unsigned long long mlen: length of input in bytes
+**************************************************/
+static void keccak_inc_absorb(uint64_t *s,
+                              unsigned int *pos,
+                              unsigned int r,
+                              const unsigned char *m,
+                              unsigned long long mlen)
+{
+  unsigned int i;
+  DBENCH_START();
+
+  /* Complete partial block */
+  while(*pos && mlen) {
+    s[*pos/8] ^= (uint64_t)*m++ << 8*(*pos%8);
+    --mlen;
+    if(++*pos == r) {
+      KeccakF1600_StatePermute(s);
+      *pos = 0;
+    }
+  }
+
+  while(mlen >= r) {
+    for(i = 0; i < r/8; ++i)
+      s[i] ^= load64(m + 8*i);
+
+    KeccakF1600_StatePermute(s);
+    mlen -= r;
+    m += r;
+  }
+
+  for(i = 0; i < mlen; ++i)
+    s[(*pos + i)/8] ^= (uint64_t)m[i] << 8*((*pos + i)%8);
+  *pos += mlen;
+
+  DBENCH_STOP(*tshake);
+}
+
+/*************************************************
+* Name:        keccak_inc_finalize
+*
+* Description: Finalize absorb step of incremental Keccak by appending the
+*              domain-separation byte and padding.
+*
+* Arguments:   - uint64_t *s: pointer to input/output Keccak state
+*              - unsigned int *pos: pointer to input/output position in block,
+*                                   set to r (block exhausted) afterwards
+*              - unsigned int r: rate in bytes (e.g., 168 for SHAKE128)
+*              - unsigned char p: domain-separation byte for different
+*                                 Keccak-derived functions
+**************************************************/
+static void keccak_inc_finalize(uint64_t *s,
+                                unsigned int *pos,
+                                unsigned int r,
+                                unsigned char p)
+{
+  s[*pos/8] ^= (uint64_t)p << 8*(*pos%8);
+  s[r/8 - 1] ^= 1ULL << 63;
+  *pos = r;
+}
+
+/*************************************************
+* Name:        keccak_inc_squeeze
+*
+* Description: Incremental squeeze step of Keccak. Squeezes arbitrarily many
+*              bytes, keeping track of the unused part of the current block.
+*
+* Arguments:   - unsigned char *h: pointer to output bytes
+*              - unsigned long long outlen: number of bytes to be squeezed
+*              - uint64_t *s: pointer to input/output Keccak state
+*              - unsigned int *pos: pointer to input/output position in block
+*              - unsigned int r: rate in bytes (e.g., 168 for SHAKE128)
+**************************************************/
+static void keccak_inc_squeeze(unsigned char *h,
+                               unsigned long long outlen,
+                               uint64_t *s,
+                               unsigned int *pos,
+                               unsigned int r)
+{
+  DBENCH_START();
+
+  while(outlen) {
+    if(*pos == r) {
+      KeccakF1600_StatePermute(s);
+      *pos = 0;
+    }
+
+    *h++ = s[*pos/8] >> 8*(*pos%8);
+    ++*pos;
+    --outlen;
+  }
+
+  DBENCH_STOP(*tshake);
+}
+
 /*************************************************
 * Name:        shake128_absorb
 *
@@ -538,6 +659,62 @@ void shake256_squeezeblocks(unsigned char *output,
   keccak_squeezeblocks(output, nblocks, state->s, SHAKE256_RATE);
 }
 
+/*************************************************
+* Name:        shake256_inc_init
+*
+* Description: Initializes the state for incremental use of SHAKE256.
+*
+* Arguments:   - keccak_state *state: pointer to output state
+**************************************************/
+void shake256_inc_init(keccak_state *state) {
+  keccak_inc_init(state->s, &state->pos);
+}
+
+/*************************************************
+* Name:        shake256_inc_absorb
+*
+* Description: Incremental absorb step of SHAKE256. Can be called multiple
+*              times with inputs of arbitrary length.
+*
+* Arguments:   - keccak_state *state: pointer to input/output state
+*              - const unsigned char *input: pointer to input to be absorbed
+*              - unsigned long long inlen: length of input in bytes
+**************************************************/
+void shake256_inc_absorb(keccak_state *state,
+                         const unsigned char *input,
+                         unsigned long long inlen)
+{
+  keccak_inc_absorb(state->s, &state->pos, SHAKE256_RATE, input, inlen);
+}
+
+/*************************************************
+* Name:        shake256_inc_finalize
+*
+* Description: Finalize absorb step of incremental SHAKE256.
+*
+* Arguments:   - keccak_state *state: pointer to input/output state
+**************************************************/
+void shake256_inc_finalize(keccak_state *state) {
+  keccak_inc_finalize(state->s, &state->pos, SHAKE256_RATE, 0x1F);
+}
+
+/*************************************************
+* Name:        shake256_inc_squeeze
+*
+* Description: Incremental squeeze step of SHAKE256. Can be called multiple
+*              times to keep squeezing.
+*
+* Arguments:   - unsigned char *output: pointer to output
+*              - unsigned long long outlen: number of bytes to be squeezed
+*              - keccak_state *state: pointer to input/output state
+**************************************************/
+void shake256_inc_squeeze(unsigned char *output,
+                          unsigned long long outlen,
+                          keccak_state *state)
+{
+  keccak_inc_squeeze(output, outlen, state->s, &state->pos, SHAKE256_RATE);
+}
+
 /*************************************************
 * Name:        shake128
 *
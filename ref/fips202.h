@@ -8,6 +8,7 @@
 
 typedef struct {
   uint64_t s[25];
+  unsigned int pos;
 } keccak_state;
 
 void shake128_absorb(keccak_state *state,
@@ -34,6 +35,15 @@ void shake256_squeezeblocks(unsigned char *output,
                             unsigned long nblocks,
                             keccak_state *state);
 
+void shake256_inc_init(keccak_state *state);
+void shake256_inc_absorb(keccak_state *state,
+                         const unsigned char *input,
+                         unsigned long long inlen);
+void shake256_inc_finalize(keccak_state *state);
+void shake256_inc_squeeze(unsigned char *output,
+                          unsigned long long outlen,
+                          keccak_state *state);
+
 void shake128(unsigned char *output,
               unsigned long long outlen,
               const unsigned char *input,
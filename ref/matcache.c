@@ -0,0 +1,345 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "params.h"
+#include "polyvec.h"
+#include "sign.h"
+#include "matcache.h"
+
+/*
+ * Set-associative cache of expanded matrices A keyed by rho. Each set holds
+ * MATCACHE_WAYS entries and is replaced in approximate LRU order. Readers
+ * never block: every entry carries a sequence counter that is odd while a
+ * writer updates it, and a reader only accepts a copy if the counter was
+ * even and unchanged around it. Writers of the same set serialize on a
+ * per-set spinlock, so writers of different sets proceed in parallel.
+ *
+ * Recency is tracked by a per-set clock that only advances on insertion. A
+ * hit stamps its entry with the current clock, and only if the stamp is
+ * stale, so repeated hits on a hot key between two insertions are pure
+ * reads. The clock and stamps live on their own cache line, away from the
+ * seq/rho line every reader loads. Hit and miss counters are spread over
+ * MATCACHE_SHARDS cache lines by thread to avoid contention.
+ */
+
+typedef struct {
+  unsigned long seq;
+  unsigned char rho[SEEDBYTES];
+  polyvecl mat[K];
+} __attribute__((aligned(64))) matcache_entry;
+
+typedef struct {
+  int lock;
+  unsigned long clock;
+  unsigned long stamps[MATCACHE_WAYS];
+} __attribute__((aligned(64))) matcache_lru;
+
+typedef struct {
+  matcache_lru lru;
+  matcache_entry entries[MATCACHE_WAYS];
+} matcache_set;
+
+typedef struct {
+  unsigned long long hits;
+  unsigned long long misses;
+} __attribute__((aligned(64))) matcache_counter;
+
+static matcache_set *sets;
+static unsigned long nsets;
+static matcache_counter counters[MATCACHE_SHARDS];
+static unsigned int next_shard;
+static __thread int shard_tls = -1;
+
+/*************************************************
+* Name:        matcache_init
+*
+* Description: Allocate matrix cache using at most the given number of bytes.
+*              A budget too small for a single set of MATCACHE_WAYS matrices
+*              disables the cache. Not thread-safe; must not be called while
+*              other threads sign or verify.
+*
+* Arguments:   - size_t bytes: memory budget in bytes
+*
+* Returns 0 on success and -1 if memory could not be allocated
+**************************************************/
+int matcache_init(size_t bytes) {
+  unsigned long i, j;
+
+  matcache_free();
+
+  nsets = bytes/sizeof(matcache_set);
+  if(nsets == 0)
+    return 0;
+
+  sets = aligned_alloc(64, nsets*sizeof(matcache_set));
+  if(!sets) {
+    nsets = 0;
+    return -1;
+  }
+
+  for(i = 0; i < nsets; ++i) {
+    sets[i].lru.lock = 0;
+    sets[i].lru.clock = 0;
+    for(j = 0; j < MATCACHE_WAYS; ++j) {
+      sets[i].lru.stamps[j] = 0;
+      sets[i].entries[j].seq = 0;
+    }
+  }
+
+  for(i = 0; i < MATCACHE_SHARDS; ++i) {
+    counters[i].hits = 0;
+    counters[i].misses = 0;
+  }
+
+  return 0;
+}
+
+/*************************************************
+* Name:        matcache_free
+*
+* Description: Free matrix cache and disable it. Not thread-safe.
+**************************************************/
+void matcache_free(void) {
+  free(sets);
+  sets = NULL;
+  nsets = 0;
+}
+
+/*************************************************
+* Name:        matcache_lookup
+*
+* Description: Try to copy a cached matrix out of a set without locking.
+*
+* Arguments:   - polyvecl mat[K]: output matrix
+*              - matcache_set *set: pointer to set to be searched
+*              - const unsigned char rho[]: byte array containing seed rho
+*
+* Returns 1 on hit and 0 on miss
+**************************************************/
+static int matcache_lookup(polyvecl mat[K],
+                           matcache_set *set,
+                           const unsigned char rho[SEEDBYTES])
+{
+  unsigned int i, j, k, diff;
+  unsigned long seq, clock;
+  matcache_entry *e;
+
+  for(i = 0; i < MATCACHE_WAYS; ++i) {
+    e = &set->entries[i];
+    seq = __atomic_load_n(&e->seq, __ATOMIC_ACQUIRE);
+    if(seq == 0 || seq & 1)
+      continue;
+
+    diff = 0;
+    for(j = 0; j < SEEDBYTES; ++j)
+      diff |= e->rho[j] ^ rho[j];
+    if(diff)
+      continue;
+
+    for(j = 0; j < K; ++j)
+      for(k = 0; k < L; ++k)
+        mat[j].vec[k] = e->mat[j].vec[k];
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if(__atomic_load_n(&e->seq, __ATOMIC_RELAXED) != seq)
+      return 0;
+
+    clock = __atomic_load_n(&set->lru.clock, __ATOMIC_RELAXED);
+    if(__atomic_load_n(&set->lru.stamps[i], __ATOMIC_RELAXED) != clock)
+      __atomic_store_n(&set->lru.stamps[i], clock, __ATOMIC_RELAXED);
+    return 1;
+  }
+
+  return 0;
+}
+
+/*************************************************
+* Name:        matcache_insert
+*
+* Description: Store matrix in the least recently used entry of a set unless
+*              another thread already inserted it. Advances the clock of
+*              the set.
+*
+* Arguments:   - matcache_set *set: pointer to set
+*              - const polyvecl mat[K]: matrix to be stored
+*              - const unsigned char rho[]: byte array containing seed rho
+**************************************************/
+static void matcache_insert(matcache_set *set,
+                            const polyvecl mat[K],
+                            const unsigned char rho[SEEDBYTES])
+{
+  unsigned int i, j, k, diff, victim;
+  unsigned long stamp, oldest;
+  matcache_entry *e;
+
+  while(__atomic_exchange_n(&set->lru.lock, 1, __ATOMIC_ACQUIRE))
+    while(__atomic_load_n(&set->lru.lock, __ATOMIC_RELAXED))
+      ;
+
+  victim = 0;
+  oldest = (unsigned long) -1;
+  for(i = 0; i < MATCACHE_WAYS; ++i) {
+    e = &set->entries[i];
+    if(e->seq) {
+      diff = 0;
+      for(j = 0; j < SEEDBYTES; ++j)
+        diff |= e->rho[j] ^ rho[j];
+      if(!diff)
+        goto unlock;
+    }
+
+    stamp = __atomic_load_n(&set->lru.stamps[i], __ATOMIC_RELAXED);
+    if(stamp < oldest) {
+      oldest = stamp;
+      victim = i;
+    }
+  }
+  e = &set->entries[victim];
+
+  /* Make entry odd while it is rewritten */
+  __atomic_store_n(&e->seq, e->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  for(j = 0; j < SEEDBYTES; ++j)
+    e->rho[j] = rho[j];
+  for(j = 0; j < K; ++j)
+    for(k = 0; k < L; ++k)
+      e->mat[j].vec[k] = mat[j].vec[k];
+
+  stamp = set->lru.clock + 1;
+  __atomic_store_n(&set->lru.clock, stamp, __ATOMIC_RELAXED);
+  __atomic_store_n(&set->lru.stamps[victim], stamp, __ATOMIC_RELAXED);
+  __atomic_store_n(&e->seq, e->seq + 1, __ATOMIC_RELEASE);
+
+  unlock:
+  __atomic_store_n(&set->lru.lock, 0, __ATOMIC_RELEASE);
+}
+
+/*************************************************
+* Name:        matcache_set_of
+*
+* Description: Find set responsible for seed rho.
+*
+* Arguments:   - const unsigned char rho[]: byte array containing seed rho
+*
+* Returns pointer to set
+**************************************************/
+static matcache_set *matcache_set_of(const unsigned char rho[SEEDBYTES]) {
+  uint32_t h;
+
+  /* rho is uniformly random, so its first bytes are a good hash */
+  h  = rho[0];
+  h |= (uint32_t)rho[1] << 8;
+  h |= (uint32_t)rho[2] << 16;
+  h |= (uint32_t)rho[3] << 24;
+  return &sets[h % nsets];
+}
+
+/*************************************************
+* Name:        matcache_counter_of
+*
+* Description: Find counter shard of the calling thread. Threads are
+*              assigned shards round-robin on first use, so threads
+*              looking up the same key count on different cache lines.
+*
+* Returns pointer to counter shard
+**************************************************/
+static matcache_counter *matcache_counter_of(void) {
+  if(shard_tls < 0)
+    shard_tls = __atomic_fetch_add(&next_shard, 1, __ATOMIC_RELAXED)
+                % MATCACHE_SHARDS;
+  return &counters[shard_tls];
+}
+
+/*************************************************
+* Name:        matcache_get
+*
+* Description: Look up matrix expanded from rho in the cache and count the
+*              hit or miss. Thread-safe.
+*
+* Arguments:   - polyvecl mat[K]: output matrix
+*              - const unsigned char rho[]: byte array containing seed rho
+*
+* Returns 1 on hit and 0 on miss or if the cache is disabled
+**************************************************/
+int matcache_get(polyvecl mat[K], const unsigned char rho[SEEDBYTES]) {
+  matcache_set *set;
+  matcache_counter *ctr;
+
+  if(!nsets)
+    return 0;
+
+  set = matcache_set_of(rho);
+  ctr = matcache_counter_of();
+  if(matcache_lookup(mat, set, rho)) {
+    __atomic_add_fetch(&ctr->hits, 1, __ATOMIC_RELAXED);
+    return 1;
+  }
+
+  __atomic_add_fetch(&ctr->misses, 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
+/*************************************************
+* Name:        matcache_put
+*
+* Description: Store matrix expanded from rho in the cache after a miss.
+*              Does nothing if the cache is disabled. Thread-safe.
+*
+* Arguments:   - const polyvecl mat[K]: matrix to be stored
+*              - const unsigned char rho[]: byte array containing seed rho
+**************************************************/
+void matcache_put(const polyvecl mat[K], const unsigned char rho[SEEDBYTES]) {
+  if(!nsets)
+    return;
+
+  matcache_insert(matcache_set_of(rho), mat, rho);
+}
+
+/*************************************************
+* Name:        matcache_expand_mat
+*
+* Description: Drop-in replacement for expand_mat that consults the matrix
+*              cache first. Falls back to expand_mat when the cache is
+*              disabled. Thread-safe.
+*
+* Arguments:   - polyvecl mat[K]: output matrix
+*              - const unsigned char rho[]: byte array containing seed rho
+**************************************************/
+void matcache_expand_mat(polyvecl mat[K], const unsigned char rho[SEEDBYTES]) {
+  if(matcache_get(mat, rho))
+    return;
+
+  expand_mat(mat, rho);
+  matcache_put(mat, rho);
+}
+
+/*************************************************
+* Name:        matcache_get_stats
+*
+* Description: Read hit and miss counters, number of occupied entries,
+*              capacity in entries and size in bytes of the matrix cache.
+*              Entries count once they have been written, even while a
+*              writer replaces them.
+*
+* Arguments:   - matcache_stats *stats: pointer to output statistics
+**************************************************/
+void matcache_get_stats(matcache_stats *stats) {
+  unsigned int i;
+  unsigned long j;
+
+  stats->hits = 0;
+  stats->misses = 0;
+  for(i = 0; i < MATCACHE_SHARDS; ++i) {
+    stats->hits += __atomic_load_n(&counters[i].hits, __ATOMIC_RELAXED);
+    stats->misses += __atomic_load_n(&counters[i].misses, __ATOMIC_RELAXED);
+  }
+
+  stats->entries = 0;
+  for(j = 0; j < nsets; ++j)
+    for(i = 0; i < MATCACHE_WAYS; ++i)
+      if(__atomic_load_n(&sets[j].entries[i].seq, __ATOMIC_RELAXED))
+        ++stats->entries;
+
+  stats->capacity = nsets*MATCACHE_WAYS;
+  stats->bytes = nsets*sizeof(matcache_set);
+}
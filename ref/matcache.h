@@ -0,0 +1,26 @@
+#ifndef MATCACHE_H
+#define MATCACHE_H
+
+#include <stddef.h>
+#include "params.h"
+#include "polyvec.h"
+
+#define MATCACHE_WAYS 4
+#define MATCACHE_SHARDS 16
+
+typedef struct {
+  unsigned long long hits;
+  unsigned long long misses;
+  unsigned long long entries;
+  unsigned long long capacity;
+  unsigned long long bytes;
+} matcache_stats;
+
+int matcache_init(size_t bytes);
+void matcache_free(void);
+int matcache_get(polyvecl mat[K], const unsigned char rho[SEEDBYTES]);
+void matcache_put(const polyvecl mat[K], const unsigned char rho[SEEDBYTES]);
+void matcache_expand_mat(polyvecl mat[K], const unsigned char rho[SEEDBYTES]);
+void matcache_get_stats(matcache_stats *stats);
+
+#endif
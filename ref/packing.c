@@ -144,40 +144,124 @@ void unpack_sk(unsigned char rho[SEEDBYTES],
 }
 
 /*************************************************
-* Name:        pack_sig
+* Name:        unpack_sk_s1
 *
-* Description: Bit-pack signature sig = (z, h, c).
+* Description: Unpack polynomial i of vector s1 from secret key.
+*
+* Arguments:   - poly *s: pointer to output polynomial
+*              - unsigned int i: index of polynomial in s1
+*              - unsigned char sk[]: byte array containing bit-packed sk
+**************************************************/
+void unpack_sk_s1(poly *s,
+                  unsigned int i,
+                  const unsigned char sk[CRYPTO_SECRETKEYBYTES])
+{
+  polyeta_unpack(s, sk + 2*SEEDBYTES + CRHBYTES + i*POLETA_SIZE_PACKED);
+}
+
+/*************************************************
+* Name:        unpack_sk_s2
+*
+* Description: Unpack polynomial i of vector s2 from secret key.
+*
+* Arguments:   - poly *s: pointer to output polynomial
+*              - unsigned int i: index of polynomial in s2
+*              - unsigned char sk[]: byte array containing bit-packed sk
+**************************************************/
+void unpack_sk_s2(poly *s,
+                  unsigned int i,
+                  const unsigned char sk[CRYPTO_SECRETKEYBYTES])
+{
+  polyeta_unpack(s, sk + 2*SEEDBYTES + CRHBYTES
+                    + (L + i)*POLETA_SIZE_PACKED);
+}
+
+/*************************************************
+* Name:        unpack_sk_t0
+*
+* Description: Unpack polynomial i of vector t0 from secret key.
+*
+* Arguments:   - poly *t: pointer to output polynomial
+*              - unsigned int i: index of polynomial in t0
+*              - unsigned char sk[]: byte array containing bit-packed sk
+**************************************************/
+void unpack_sk_t0(poly *t,
+                  unsigned int i,
+                  const unsigned char sk[CRYPTO_SECRETKEYBYTES])
+{
+  polyt0_unpack(t, sk + 2*SEEDBYTES + CRHBYTES
+                   + (L + K)*POLETA_SIZE_PACKED + i*POLT0_SIZE_PACKED);
+}
+
+/*************************************************
+* Name:        pack_sig_z
+*
+* Description: Bit-pack polynomial i of vector z into signature.
 *
 * Arguments:   - unsigned char sig[]: output byte array
-*              - const polyvecl *z: pointer to vector z
-*              - const polyveck *h: pointer to hint vector h
-*              - const poly *c: pointer to challenge polynomial
+*              - const poly *z: pointer to polynomial
+*              - unsigned int i: index of polynomial in z
 **************************************************/
-void pack_sig(unsigned char sig[CRYPTO_BYTES],
-              const polyvecl *z,
-              const polyveck *h,
-              const poly *c)
+void pack_sig_z(unsigned char sig[CRYPTO_BYTES],
+                const poly *z,
+                unsigned int i)
 {
-  unsigned int i, j, k;
-  uint64_t signs, mask;
+  polyz_pack(sig + i*POLZ_SIZE_PACKED, z);
+}
+
+/*************************************************
+* Name:        pack_sig_hint
+*
+* Description: Encode polynomial i of hint vector h into signature. The
+*              polynomials must be encoded in order; after the last one the
+*              unused index slots are cleared. Indices beyond OMEGA are
+*              counted but not written.
+*
+* Arguments:   - unsigned char sig[]: output byte array
+*              - const poly *h: pointer to hint polynomial
+*              - unsigned int i: index of polynomial in h
+*              - unsigned int k: number of hints in polynomials 0 to i - 1
+*
+* Returns number of hints in polynomials 0 to i
+**************************************************/
+unsigned int pack_sig_hint(unsigned char sig[CRYPTO_BYTES],
+                           const poly *h,
+                           unsigned int i,
+                           unsigned int k)
+{
+  unsigned int j;
 
-  for(i = 0; i < L; ++i)
-    polyz_pack(sig + i*POLZ_SIZE_PACKED, &z->vec[i]);
   sig += L*POLZ_SIZE_PACKED;
 
-  /* Encode h */
-  k = 0;
-  for(i = 0; i < K; ++i) {
-    for(j = 0; j < N; ++j)
-      if(h->vec[i].coeffs[j] != 0)
-        sig[k++] = j;
+  for(j = 0; j < N; ++j)
+    if(h->coeffs[j] != 0) {
+      if(k < OMEGA)
+        sig[k] = j;
+      ++k;
+    }
 
-    sig[OMEGA + i] = k;
-  }
-  while(k < OMEGA) sig[k++] = 0;
-  sig += OMEGA + K;
+  sig[OMEGA + i] = k;
+  if(i == K - 1)
+    for(j = k; j < OMEGA; ++j)
+      sig[j] = 0;
+
+  return k;
+}
+
+/*************************************************
+* Name:        pack_sig_c
+*
+* Description: Bit-pack challenge polynomial c into signature.
+*
+* Arguments:   - unsigned char sig[]: output byte array
+*              - const poly *c: pointer to challenge polynomial
+**************************************************/
+void pack_sig_c(unsigned char sig[CRYPTO_BYTES], const poly *c) {
+  unsigned int i, j;
+  uint64_t signs, mask;
+
+  sig += L*POLZ_SIZE_PACKED + OMEGA + K;
 
-  /* Encode c */
   signs = 0;
   mask = 1;
   for(i = 0; i < N/8; ++i) {
@@ -196,43 +280,56 @@ void pack_sig(unsigned char sig[CRYPTO_BYTES],
 }
 
 /*************************************************
-* Name:        unpack_sig
-*
-* Description: Unpack signature sig = (z, h, c).
+* Name:        pack_sig
 *
-* Arguments:   - polyvecl *z: pointer to output vector z
-*              - polyveck *h: pointer to output hint vector h
-*              - poly *c: pointer to output challenge polynomial
-*              - const unsigned char sig[]: byte array containing
-*                bit-packed signature
+* Description: Bit-pack signature sig = (z, h, c).
 *
-* Returns 1 in case of malformed signature; otherwise 0.
+* Arguments:   - unsigned char sig[]: output byte array
+*              - const polyvecl *z: pointer to vector z
+*              - const polyveck *h: pointer to hint vector h
+*              - const poly *c: pointer to challenge polynomial
 **************************************************/
-int unpack_sig(polyvecl *z,
-               polyveck *h,
-               poly *c,
-               const unsigned char sig[CRYPTO_BYTES])
+void pack_sig(unsigned char sig[CRYPTO_BYTES],
+              const polyvecl *z,
+              const polyveck *h,
+              const poly *c)
 {
-  unsigned int i, j, k;
-  uint64_t signs;
+  unsigned int i, k;
 
   for(i = 0; i < L; ++i)
-    polyz_unpack(&z->vec[i], sig + i*POLZ_SIZE_PACKED);
-  sig += L*POLZ_SIZE_PACKED;
+    pack_sig_z(sig, &z->vec[i], i);
 
-  /* Decode h */
+  /* Encode h */
   k = 0;
-  for(i = 0; i < K; ++i) {
-    for(j = 0; j < N; ++j)
-      h->vec[i].coeffs[j] = 0;
+  for(i = 0; i < K; ++i)
+    k = pack_sig_hint(sig, &h->vec[i], i, k);
+
+  /* Encode c */
+  pack_sig_c(sig, c);
+}
+
+/*************************************************
+* Name:        unpack_hint_check
+*
+* Description: Check encoding of hint vector h in signature without
+*              decoding it.
+*
+* Arguments:   - const unsigned char sig[]: byte array containing
+*                bit-packed hint vector
+*
+* Returns 1 in case of malformed encoding; otherwise 0.
+**************************************************/
+static int unpack_hint_check(const unsigned char *sig) {
+  unsigned int i, j, k;
 
+  k = 0;
+  for(i = 0; i < K; ++i) {
     if(sig[OMEGA + i] < k || sig[OMEGA + i] > OMEGA)
       return 1;
 
     for(j = k; j < sig[OMEGA + i]; ++j) {
       /* Coefficients are ordered for strong unforgeability */
       if(j > k && sig[j] <= sig[j-1]) return 1;
-      h->vec[i].coeffs[sig[j]] = 1;
     }
 
     k = sig[OMEGA + i];
@@ -243,9 +340,46 @@ int unpack_sig(polyvecl *z,
     if(sig[j])
       return 1;
 
-  sig += OMEGA + K;
+  return 0;
+}
+
+/*************************************************
+* Name:        unpack_hint
+*
+* Description: Decode polynomial i of hint vector h. Assumes encoding has
+*              been checked with unpack_hint_check.
+*
+* Arguments:   - poly *h: pointer to output hint polynomial
+*              - unsigned int i: index of polynomial in h
+*              - const unsigned char sig[]: byte array containing
+*                bit-packed hint vector
+**************************************************/
+static void unpack_hint(poly *h, unsigned int i, const unsigned char *sig) {
+  unsigned int j, k;
+
+  for(j = 0; j < N; ++j)
+    h->coeffs[j] = 0;
+
+  k = i ? sig[OMEGA + i - 1] : 0;
+  for(j = k; j < sig[OMEGA + i]; ++j)
+    h->coeffs[sig[j]] = 1;
+}
+
+/*************************************************
+* Name:        unpack_challenge
+*
+* Description: Decode challenge polynomial c.
+*
+* Arguments:   - poly *c: pointer to output challenge polynomial
+*              - const unsigned char sig[]: byte array containing
+*                bit-packed challenge
+*
+* Returns 1 in case of malformed encoding; otherwise 0.
+**************************************************/
+static int unpack_challenge(poly *c, const unsigned char *sig) {
+  unsigned int i, j;
+  uint64_t signs;
 
-  /* Decode c */
   for(i = 0; i < N; ++i)
     c->coeffs[i] = 0;
 
@@ -269,3 +403,87 @@ int unpack_sig(polyvecl *z,
 
   return 0;
 }
+
+/*************************************************
+* Name:        unpack_sig
+*
+* Description: Unpack signature sig = (z, h, c).
+*
+* Arguments:   - polyvecl *z: pointer to output vector z
+*              - polyveck *h: pointer to output hint vector h
+*              - poly *c: pointer to output challenge polynomial
+*              - const unsigned char sig[]: byte array containing
+*                bit-packed signature
+*
+* Returns 1 in case of malformed signature; otherwise 0.
+**************************************************/
+int unpack_sig(polyvecl *z,
+               polyveck *h,
+               poly *c,
+               const unsigned char sig[CRYPTO_BYTES])
+{
+  unsigned int i;
+
+  for(i = 0; i < L; ++i)
+    polyz_unpack(&z->vec[i], sig + i*POLZ_SIZE_PACKED);
+  sig += L*POLZ_SIZE_PACKED;
+
+  /* Decode h */
+  if(unpack_hint_check(sig))
+    return 1;
+  for(i = 0; i < K; ++i)
+    unpack_hint(&h->vec[i], i, sig);
+  sig += OMEGA + K;
+
+  /* Decode c */
+  return unpack_challenge(c, sig);
+}
+
+/*************************************************
+* Name:        unpack_sig_zc
+*
+* Description: Unpack z and c from signature and check encoding of h,
+*              which is left in the signature to be decoded polynomial by
+*              polynomial with unpack_sig_hint.
+*
+* Arguments:   - polyvecl *z: pointer to output vector z
+*              - poly *c: pointer to output challenge polynomial
+*              - const unsigned char sig[]: byte array containing
+*                bit-packed signature
+*
+* Returns 1 in case of malformed signature; otherwise 0.
+**************************************************/
+int unpack_sig_zc(polyvecl *z,
+                  poly *c,
+                  const unsigned char sig[CRYPTO_BYTES])
+{
+  unsigned int i;
+
+  for(i = 0; i < L; ++i)
+    polyz_unpack(&z->vec[i], sig + i*POLZ_SIZE_PACKED);
+  sig += L*POLZ_SIZE_PACKED;
+
+  if(unpack_hint_check(sig))
+    return 1;
+  sig += OMEGA + K;
+
+  return unpack_challenge(c, sig);
+}
+
+/*************************************************
+* Name:        unpack_sig_hint
+*
+* Description: Decode polynomial i of hint vector h from signature whose
+*              encoding has been checked by unpack_sig_zc.
+*
+* Arguments:   - poly *h: pointer to output hint polynomial
+*              - unsigned int i: index of polynomial in h
+*              - const unsigned char sig[]: byte array containing
+*                bit-packed signature
+**************************************************/
+void unpack_sig_hint(poly *h,
+                     unsigned int i,
+                     const unsigned char sig[CRYPTO_BYTES])
+{
+  unpack_hint(h, i, sig + L*POLZ_SIZE_PACKED);
+}
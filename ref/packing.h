@@ -15,6 +15,11 @@ void pack_sk(unsigned char sk[CRYPTO_SECRETKEYBYTES],
              const polyveck *t0);
 void pack_sig(unsigned char sig[CRYPTO_BYTES],
               const polyvecl *z, const polyveck *h, const poly *c);
+void pack_sig_z(unsigned char sig[CRYPTO_BYTES], const poly *z,
+                unsigned int i);
+unsigned int pack_sig_hint(unsigned char sig[CRYPTO_BYTES], const poly *h,
+                           unsigned int i, unsigned int k);
+void pack_sig_c(unsigned char sig[CRYPTO_BYTES], const poly *c);
 
 void unpack_pk(unsigned char rho[SEEDBYTES], polyveck *t1,
                const unsigned char pk[CRYPTO_PUBLICKEYBYTES]);
@@ -25,7 +30,17 @@ void unpack_sk(unsigned char rho[SEEDBYTES],
                polyveck *s2,
                polyveck *t0,
                const unsigned char sk[CRYPTO_SECRETKEYBYTES]);
+void unpack_sk_s1(poly *s, unsigned int i,
+                  const unsigned char sk[CRYPTO_SECRETKEYBYTES]);
+void unpack_sk_s2(poly *s, unsigned int i,
+                  const unsigned char sk[CRYPTO_SECRETKEYBYTES]);
+void unpack_sk_t0(poly *t, unsigned int i,
+                  const unsigned char sk[CRYPTO_SECRETKEYBYTES]);
 int unpack_sig(polyvecl *z, polyveck *h, poly *c,
                const unsigned char sig[CRYPTO_BYTES]);
+int unpack_sig_zc(polyvecl *z, poly *c,
+                  const unsigned char sig[CRYPTO_BYTES]);
+void unpack_sig_hint(poly *h, unsigned int i,
+                     const unsigned char sig[CRYPTO_BYTES]);
 
 #endif
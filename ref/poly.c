@@ -179,6 +179,53 @@ void poly_pointwise_invmontgomery(poly *c, const poly *a, const poly *b) {
   DBENCH_STOP(*tmul);
 }
 
+/*************************************************
+* Name:        poly_prepare
+*
+* Description: Prepare polynomial in NTT domain as fixed operand of
+*              poly_pointwise_prepared. Input coefficients can be arbitrary.
+*              The input may alias r->w.
+*
+* Arguments:   - poly_prepared *r: pointer to output prepared polynomial
+*              - const poly *a: pointer to input polynomial
+**************************************************/
+void poly_prepare(poly_prepared *r, const poly *a) {
+  unsigned int i;
+  uint32_t t;
+
+  for(i = 0; i < N; ++i) {
+    t = csubq(montgomery_reduce(a->coeffs[i]));
+    r->w.coeffs[i] = t;
+    r->wprime.coeffs[i] = ((uint64_t)t << 32) / Q;
+  }
+}
+
+/*************************************************
+* Name:        poly_pointwise_prepared
+*
+* Description: Pointwise multiplication of polynomial in NTT domain with
+*              prepared polynomial using Shoup's method. Computes the same
+*              residues as poly_pointwise_invmontgomery with the unprepared
+*              operand. Output coefficients are less than 2*Q for arbitrary
+*              input coefficients.
+*
+* Arguments:   - poly *c: pointer to output polynomial
+*              - const poly *a: pointer to input polynomial
+*              - const poly_prepared *b: pointer to prepared polynomial
+**************************************************/
+void poly_pointwise_prepared(poly *c, const poly *a, const poly_prepared *b) {
+  unsigned int i;
+  uint32_t q;
+  DBENCH_START();
+
+  for(i = 0; i < N; ++i) {
+    q = ((uint64_t)a->coeffs[i] * b->wprime.coeffs[i]) >> 32;
+    c->coeffs[i] = a->coeffs[i] * b->w.coeffs[i] - q * Q;
+  }
+
+  DBENCH_STOP(*tmul);
+}
+
 /*************************************************
 * Name:        poly_power2round
 *
@@ -857,3 +904,23 @@ void polyw1_pack(unsigned char *r, const poly *a) {
 
   DBENCH_STOP(*tpack);
 }
+
+/*************************************************
+* Name:        polyw1_unpack
+*
+* Description: Unpack polynomial w1 with coefficients in [0, 15].
+*
+* Arguments:   - poly *r: pointer to output polynomial
+*              - const unsigned char *a: byte array with bit-packed polynomial
+**************************************************/
+void polyw1_unpack(poly *r, const unsigned char *a) {
+  unsigned int i;
+  DBENCH_START();
+
+  for(i = 0; i < N/2; ++i) {
+    r->coeffs[2*i+0] = a[i] & 0x0F;
+    r->coeffs[2*i+1] = a[i] >> 4;
+  }
+
+  DBENCH_STOP(*tpack);
+}
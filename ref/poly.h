@@ -8,6 +8,16 @@ typedef struct {
   uint32_t coeffs[N];
 } poly __attribute__((aligned(32)));
 
+/*
+ * Fixed multiplication operand in NTT domain with precomputed Shoup
+ * companion: w holds the operand times 2^{-32} reduced to [0,Q) and
+ * wprime[i] = floor(w[i]*2^32/Q).
+ */
+typedef struct {
+  poly w;
+  poly wprime;
+} poly_prepared;
+
 void poly_reduce(poly *a);
 void poly_csubq(poly *a);
 void poly_freeze(poly *a);
@@ -19,6 +29,8 @@ void poly_shiftl(poly *a);
 void poly_ntt(poly *a);
 void poly_invntt_montgomery(poly *a);
 void poly_pointwise_invmontgomery(poly *c, const poly *a, const poly *b);
+void poly_prepare(poly_prepared *r, const poly *a);
+void poly_pointwise_prepared(poly *c, const poly *a, const poly_prepared *b);
 
 void poly_power2round(poly *a1, poly *a0, const poly *a);
 void poly_decompose(poly *a1, poly *a0, const poly *a);
@@ -49,5 +61,6 @@ void polyz_pack(unsigned char *r, const poly *a);
 void polyz_unpack(poly *r, const unsigned char *a);
 
 void polyw1_pack(unsigned char *r, const poly *a);
+void polyw1_unpack(poly *r, const unsigned char *a);
 
 #endif
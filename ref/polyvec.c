@@ -2,6 +2,7 @@
 #include "params.h"
 #include "poly.h"
 #include "polyvec.h"
+#include "reduce.h"
 
 /**************************************************************/
 /************ Vectors of polynomials of length L **************/
@@ -82,6 +83,40 @@ void polyvecl_pointwise_acc_invmontgomery(poly *w,
   }
 }
 
+/*************************************************
+* Name:        polyvecl_pointwise_acc_invntt
+*
+* Description: Compute inner product of vectors of polynomials of length L
+*              in NTT domain and transform the result back to normal domain,
+*              i.e. one row of a matrix-vector product. The products are
+*              accumulated in 64 bits without intermediate reductions.
+*              Coefficients of u are assumed to be less than Q and those of
+*              v less than 22*Q, so the sum of all L products is at most
+*              Q*2^32 and is brought below 2*Q by a single Montgomery
+*              reduction, as required by the inverse NTT. Output
+*              coefficients are less than 2*Q.
+*
+* Arguments:   - poly *w: output polynomial
+*              - const polyvecl *u: pointer to first input vector
+*              - const polyvecl *v: pointer to second input vector
+**************************************************/
+void polyvecl_pointwise_acc_invntt(poly *w,
+                                   const polyvecl *u,
+                                   const polyvecl *v)
+{
+  unsigned int i, j;
+  uint64_t t;
+
+  for(i = 0; i < N; ++i) {
+    t = 0;
+    for(j = 0; j < L; ++j)
+      t += (uint64_t)u->vec[j].coeffs[i] * v->vec[j].coeffs[i];
+    w->coeffs[i] = montgomery_reduce(t);
+  }
+
+  poly_invntt_montgomery(w);
+}
+
 /*************************************************
 * Name:        polyvecl_chknorm
 *
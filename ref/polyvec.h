@@ -18,9 +18,17 @@ void polyvecl_ntt(polyvecl *v);
 void polyvecl_pointwise_acc_invmontgomery(poly *w,
                                           const polyvecl *u,
                                           const polyvecl *v);
+void polyvecl_pointwise_acc_invntt(poly *w,
+                                   const polyvecl *u,
+                                   const polyvecl *v);
 
 int polyvecl_chknorm(const polyvecl *v, uint32_t B);
 
+/* Vectors of prepared polynomials of length L */
+typedef struct {
+  poly_prepared vec[L];
+} polyvecl_prepared;
+
 
 
 /* Vectors of polynomials of length K */
@@ -28,6 +36,11 @@ typedef struct {
   poly vec[K];
 } polyveck;
 
+/* Vectors of prepared polynomials of length K */
+typedef struct {
+  poly_prepared vec[K];
+} polyveck_prepared;
+
 void polyveck_reduce(polyveck *v);
 void polyveck_csubq(polyveck *v);
 void polyveck_freeze(polyveck *v);
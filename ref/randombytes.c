@@ -1,9 +1,13 @@
 #include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/syscall.h>
+#include <pthread.h>
+#include "fips202.h"
 #include "randombytes.h"
 
 #define _GNU_SOURCE
@@ -36,7 +40,7 @@ static void randombytes_fallback(unsigned char *x, size_t xlen)
 }
 
 #ifdef SYS_getrandom
-void randombytes(unsigned char *buf, size_t buflen)
+void randombytes_system(unsigned char *buf, size_t buflen)
 {
   size_t d = 0;
   int r;
@@ -56,9 +60,165 @@ void randombytes(unsigned char *buf, size_t buflen)
   }
 }
 #else
-void randombytes(unsigned char *buf, size_t buflen)
+void randombytes_system(unsigned char *buf, size_t buflen)
 {
   randombytes_fallback(buf, buflen);
 }
 #endif
 
+/*
+ * Per-thread fast-key-erasure DRBG. Every refill absorbs the current key
+ * into SHAKE256 and squeezes DRBG_BLOCKS blocks; the first DRBG_KEYBYTES
+ * bytes replace the key and the rest is handed out, erasing every byte
+ * as it leaves the buffer. The key is mixed with fresh bytes from the
+ * kernel on first use, every DRBG_RESEED refills and after fork.
+ * The state is allocated on the first call in each thread, so threads that
+ * never use the DRBG do not pay for it, and is erased when the thread
+ * exits.
+ */
+#define DRBG_KEYBYTES 32
+#define DRBG_BLOCKS 16
+#define DRBG_BUFBYTES (DRBG_BLOCKS*SHAKE256_RATE)
+#define DRBG_RESEED 1024
+
+typedef struct {
+  unsigned char key[DRBG_KEYBYTES];
+  unsigned char buf[DRBG_BUFBYTES];
+  unsigned int pos;
+  unsigned int refills;
+  unsigned int forks;
+  int seeded;
+} drbg_state;
+
+static pthread_key_t drbg_key;
+static unsigned int drbg_forks;
+static pthread_once_t drbg_once = PTHREAD_ONCE_INIT;
+
+static void drbg_erase(void *p, size_t len)
+{
+  volatile unsigned char *v = p;
+
+  while(len--)
+    *v++ = 0;
+}
+
+static void drbg_free(void *p)
+{
+  drbg_erase(p, sizeof(drbg_state));
+  free(p);
+}
+
+static void drbg_atfork_child(void)
+{
+  __atomic_add_fetch(&drbg_forks, 1, __ATOMIC_RELAXED);
+}
+
+static void drbg_register(void)
+{
+  pthread_key_create(&drbg_key, drbg_free);
+  pthread_atfork(NULL, NULL, drbg_atfork_child);
+}
+
+static void drbg_refill(drbg_state *s)
+{
+  unsigned int forks, inlen = DRBG_KEYBYTES;
+  unsigned char in[2*DRBG_KEYBYTES];
+  keccak_state state;
+
+  forks = __atomic_load_n(&drbg_forks, __ATOMIC_RELAXED);
+  memcpy(in, s->key, DRBG_KEYBYTES);
+  if(!s->seeded || s->forks != forks || s->refills >= DRBG_RESEED) {
+    randombytes_system(in + DRBG_KEYBYTES, DRBG_KEYBYTES);
+    inlen += DRBG_KEYBYTES;
+    s->seeded = 1;
+    s->forks = forks;
+    s->refills = 0;
+  }
+
+  shake256_absorb(&state, in, inlen);
+  shake256_squeezeblocks(s->buf, DRBG_BLOCKS, &state);
+  memcpy(s->key, s->buf, DRBG_KEYBYTES);
+  drbg_erase(s->buf, DRBG_KEYBYTES);
+  s->pos = DRBG_KEYBYTES;
+  ++s->refills;
+
+  drbg_erase(in, sizeof(in));
+  drbg_erase(&state, sizeof(state));
+}
+
+/*************************************************
+* Name:        randombytes_drbg
+*
+* Description: Fill buffer with output of the calling thread's DRBG. A
+*              forked child never repeats output of its parent. If the
+*              state cannot be allocated, falls back to randombytes_system.
+*
+* Arguments:   - unsigned char *buf: pointer to output buffer
+*              - size_t buflen: number of bytes to write
+**************************************************/
+void randombytes_drbg(unsigned char *buf, size_t buflen)
+{
+  size_t n;
+  drbg_state *s;
+
+  pthread_once(&drbg_once, drbg_register);
+  s = pthread_getspecific(drbg_key);
+  if(!s) {
+    s = calloc(1, sizeof(drbg_state));
+    if(!s || pthread_setspecific(drbg_key, s)) {
+      free(s);
+      randombytes_system(buf, buflen);
+      return;
+    }
+  }
+
+  if(!s->seeded || s->forks != __atomic_load_n(&drbg_forks, __ATOMIC_RELAXED))
+    drbg_refill(s);
+
+  while(buflen > 0) {
+    if(s->pos == DRBG_BUFBYTES)
+      drbg_refill(s);
+
+    n = DRBG_BUFBYTES - s->pos;
+    if(n > buflen)
+      n = buflen;
+    memcpy(buf, s->buf + s->pos, n);
+    drbg_erase(s->buf + s->pos, n);
+    s->pos += n;
+    buf += n;
+    buflen -= n;
+  }
+}
+
+#ifdef RANDOMBYTES_DRBG
+static randombytes_fn randombytes_source = randombytes_drbg;
+#else
+static randombytes_fn randombytes_source = randombytes_system;
+#endif
+
+/*************************************************
+* Name:        randombytes_set_source
+*
+* Description: Set the function behind randombytes, e.g. randombytes_drbg,
+*              randombytes_system or one supplied by the application.
+*              Must not be called while other threads use randombytes.
+*
+* Arguments:   - randombytes_fn f: source of random bytes, NULL restores
+*                                  the default
+**************************************************/
+void randombytes_set_source(randombytes_fn f)
+{
+  if(!f)
+#ifdef RANDOMBYTES_DRBG
+    f = randombytes_drbg;
+#else
+    f = randombytes_system;
+#endif
+  randombytes_source = f;
+}
+
+void randombytes(unsigned char *buf, size_t buflen)
+{
+  randombytes_source(buf, buflen);
+}
+
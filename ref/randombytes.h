@@ -5,6 +5,11 @@
 
 #include <unistd.h>
 
+typedef void (*randombytes_fn)(unsigned char *x, size_t xlen);
+
 void randombytes(unsigned char *x, size_t xlen);
+void randombytes_system(unsigned char *x, size_t xlen);
+void randombytes_drbg(unsigned char *x, size_t xlen);
+void randombytes_set_source(randombytes_fn f);
 
 #endif
@@ -7,6 +7,8 @@
 #include "poly.h"
 #include "polyvec.h"
 #include "packing.h"
+#include "matcache.h"
+#include "signstats.h"
 
 /*************************************************
 * Name:        expand_mat
@@ -26,34 +28,330 @@ void expand_mat(polyvecl mat[K], const unsigned char rho[SEEDBYTES]) {
       poly_uniform(&mat[i].vec[j], rho, (i << 8) + j);
 }
 
+typedef struct {
+  polyvecl *mat;
+  const unsigned char *rho;
+} expand_mat_task;
+
+typedef struct {
+  const polyvecl *mat;
+  const polyvecl *v;
+  poly *w;
+} matmul_task;
+
+typedef struct {
+  const poly *c;
+  const poly_prepared *v;
+  const poly *u;
+  poly *w;
+} polymul_task;
+
+typedef struct {
+  poly *s[3];
+  poly_prepared *p[3];
+  const unsigned char *sk;
+} sk_unpack_task;
+
+/*
+ * Secret key in NTT domain without the preparation of s1, s2 and t0. The
+ * one-shot signing functions expand the key into it on their stack, which
+ * keeps their frame (L + 2*K) KiB smaller than with an expanded_sk.
+ */
+typedef struct {
+  polyvecl mat[K];
+  polyvecl s1;
+  polyveck s2;
+  polyveck t0;
+  unsigned char tr[CRHBYTES];
+  unsigned char key[SEEDBYTES];
+} oneshot_sk;
+
+/*
+ * Secret key operands of the signing loop, pointing into an expanded_sk or
+ * a oneshot_sk. Of s1, s2 and t0 either the prepared or the plain NTT
+ * domain polynomials are set, the other pointers are NULL.
+ */
+typedef struct {
+  const polyvecl *mat;
+  const poly_prepared *s1, *s2, *t0;
+  const poly *s1plain, *s2plain, *t0plain;
+  const unsigned char *tr;
+  const unsigned char *key;
+} sign_key;
+
 /*************************************************
-* Name:        challenge
+* Name:        expand_mat_task_run
 *
-* Description: Implementation of H. Samples polynomial with 60 nonzero
-*              coefficients in {-1,1} using the output stream of
-*              SHAKE256(mu|w1).
+* Description: Task generating row i of matrix A.
 *
-* Arguments:   - poly *c: pointer to output polynomial
-*              - const unsigned char mu[]: byte array containing mu
-*              - const polyveck *w1: pointer to vector w1
+* Arguments:   - void *arg: pointer to expand_mat_task
+*              - unsigned int i: row index
 **************************************************/
-void challenge(poly *c,
-               const unsigned char mu[CRHBYTES],
-               const polyveck *w1)
+static void expand_mat_task_run(void *arg, unsigned int i) {
+  unsigned int j;
+  expand_mat_task *t = arg;
+
+  for(j = 0; j < L; ++j)
+    poly_uniform(&t->mat[i].vec[j], t->rho, (i << 8) + j);
+}
+
+/*************************************************
+* Name:        expand_mat_parallel
+*
+* Description: Generate matrix A with rows distributed over a thread pool.
+*              Output is identical to expand_mat.
+*
+* Arguments:   - polyvecl mat[K]: output matrix
+*              - const unsigned char rho[]: byte array containing seed rho
+*              - threadpool *pool: pointer to thread pool, may be NULL
+**************************************************/
+static void expand_mat_parallel(polyvecl mat[K],
+                                const unsigned char rho[SEEDBYTES],
+                                threadpool *pool)
+{
+  expand_mat_task t;
+
+  if(!pool || !pool->nthreads) {
+    expand_mat(mat, rho);
+    return;
+  }
+
+  t.mat = mat;
+  t.rho = rho;
+  threadpool_run(pool, expand_mat_task_run, &t, K);
+}
+
+/*************************************************
+* Name:        matmul_task_run
+*
+* Description: Task computing row i of A*v for v in NTT domain and
+*              transforming it back to normal domain.
+*
+* Arguments:   - void *arg: pointer to matmul_task
+*              - unsigned int i: row index
+**************************************************/
+static void matmul_task_run(void *arg, unsigned int i) {
+  matmul_task *t = arg;
+
+  polyvecl_pointwise_acc_invntt(&t->w[i], &t->mat[i], t->v);
+}
+
+/*************************************************
+* Name:        matmul_parallel
+*
+* Description: Compute w = INTT(A*v) with the K rows distributed over a
+*              thread pool.
+*
+* Arguments:   - poly *w: output array of K polynomials
+*              - const polyvecl mat[K]: matrix A in NTT domain
+*              - const polyvecl *v: pointer to vector in NTT domain
+*              - threadpool *pool: pointer to thread pool, may be NULL
+**************************************************/
+static void matmul_parallel(poly *w,
+                            const polyvecl mat[K],
+                            const polyvecl *v,
+                            threadpool *pool)
+{
+  matmul_task t;
+
+  t.mat = mat;
+  t.v = v;
+  t.w = w;
+  threadpool_run(pool, matmul_task_run, &t, K);
+}
+
+/*************************************************
+* Name:        polymul_task_run
+*
+* Description: Task computing polynomial i of INTT(c*v) for c in NTT domain
+*              and v either prepared or plain in NTT domain.
+*
+* Arguments:   - void *arg: pointer to polymul_task
+*              - unsigned int i: polynomial index
+**************************************************/
+static void polymul_task_run(void *arg, unsigned int i) {
+  polymul_task *t = arg;
+
+  if(t->v)
+    poly_pointwise_prepared(&t->w[i], t->c, &t->v[i]);
+  else
+    poly_pointwise_invmontgomery(&t->w[i], t->c, &t->u[i]);
+  poly_invntt_montgomery(&t->w[i]);
+}
+
+/*************************************************
+* Name:        polymul_parallel
+*
+* Description: Multiply n polynomials by the same polynomial c with the
+*              products distributed over a thread pool.
+*
+* Arguments:   - poly *w: output array of n polynomials
+*              - const poly *c: pointer to polynomial in NTT domain
+*              - const poly_prepared *v: array of n prepared polynomials,
+*                                        or NULL
+*              - const poly *u: array of n polynomials in NTT domain, used
+*                               if v is NULL
+*              - unsigned int n: number of polynomials
+*              - threadpool *pool: pointer to thread pool, may be NULL
+**************************************************/
+static void polymul_parallel(poly *w,
+                             const poly *c,
+                             const poly_prepared *v,
+                             const poly *u,
+                             unsigned int n,
+                             threadpool *pool)
+{
+  polymul_task t;
+
+  t.c = c;
+  t.v = v;
+  t.u = u;
+  t.w = w;
+  threadpool_run(pool, polymul_task_run, &t, n);
+}
+
+/*************************************************
+* Name:        sk_unpack_task_run
+*
+* Description: Task unpacking polynomial i of s1|s2|t0 from the secret key,
+*              transforming it to NTT domain and, if prepared outputs are
+*              given, preparing it for multiplication.
+*
+* Arguments:   - void *arg: pointer to sk_unpack_task
+*              - unsigned int i: polynomial index
+**************************************************/
+static void sk_unpack_task_run(void *arg, unsigned int i) {
+  sk_unpack_task *t = arg;
+  unsigned int j;
+  poly *a;
+
+  if(i < L)
+    j = 0;
+  else if(i < L + K) {
+    j = 1;
+    i -= L;
+  }
+  else {
+    j = 2;
+    i -= L + K;
+  }
+
+  a = t->p[j] ? &t->p[j][i].w : &t->s[j][i];
+  if(j == 0)
+    unpack_sk_s1(a, i, t->sk);
+  else if(j == 1)
+    unpack_sk_s2(a, i, t->sk);
+  else
+    unpack_sk_t0(a, i, t->sk);
+
+  poly_ntt(a);
+  if(t->p[j])
+    poly_prepare(&t->p[j][i], a);
+}
+
+/*************************************************
+* Name:        sk_expand
+*
+* Description: Copy tr and key from the secret key, generate A or fetch it
+*              from the matrix cache, and unpack s1, s2 and t0 into the
+*              outputs given in the task.
+*
+* Arguments:   - polyvecl mat[K]: output matrix
+*              - unsigned char tr[]: output byte array for tr
+*              - unsigned char key[]: output byte array for key
+*              - sk_unpack_task *t: pointer to task with outputs for s1, s2
+*                                   and t0 and the bit-packed secret key
+*              - threadpool *pool: pointer to thread pool, may be NULL
+**************************************************/
+static void sk_expand(polyvecl mat[K],
+                      unsigned char tr[CRHBYTES],
+                      unsigned char key[SEEDBYTES],
+                      sk_unpack_task *t,
+                      threadpool *pool)
+{
+  unsigned int i;
+  const unsigned char *rho = t->sk;
+
+  for(i = 0; i < SEEDBYTES; ++i)
+    key[i] = t->sk[SEEDBYTES + i];
+  for(i = 0; i < CRHBYTES; ++i)
+    tr[i] = t->sk[2*SEEDBYTES + i];
+
+  if(!matcache_get(mat, rho)) {
+    expand_mat_parallel(mat, rho, pool);
+    matcache_put(mat, rho);
+  }
+
+  threadpool_run(pool, sk_unpack_task_run, t, L + 2*K);
+}
+
+/*************************************************
+* Name:        oneshot_sk_expand
+*
+* Description: Expand secret key for a single signature without preparing
+*              s1, s2 and t0, and point the signing operands at it.
+*
+* Arguments:   - oneshot_sk *osk: pointer to output key in NTT domain
+*              - sign_key *key: pointer to output signing operands
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*              - threadpool *pool: pointer to thread pool, may be NULL
+**************************************************/
+static void oneshot_sk_expand(oneshot_sk *osk,
+                              sign_key *key,
+                              const unsigned char *sk,
+                              threadpool *pool)
 {
+  sk_unpack_task t;
+
+  t.s[0] = osk->s1.vec;
+  t.s[1] = osk->s2.vec;
+  t.s[2] = osk->t0.vec;
+  t.p[0] = t.p[1] = t.p[2] = NULL;
+  t.sk = sk;
+  sk_expand(osk->mat, osk->tr, osk->key, &t, pool);
+
+  key->mat = osk->mat;
+  key->s1 = key->s2 = key->t0 = NULL;
+  key->s1plain = osk->s1.vec;
+  key->s2plain = osk->s2.vec;
+  key->t0plain = osk->t0.vec;
+  key->tr = osk->tr;
+  key->key = osk->key;
+}
+
+/*************************************************
+* Name:        sign_key_expanded
+*
+* Description: Point the signing operands at an expanded secret key.
+*
+* Arguments:   - sign_key *key: pointer to output signing operands
+*              - const expanded_sk *esk: pointer to expanded secret key
+**************************************************/
+static void sign_key_expanded(sign_key *key, const expanded_sk *esk) {
+  key->mat = esk->mat;
+  key->s1 = esk->s1.vec;
+  key->s2 = esk->s2.vec;
+  key->t0 = esk->t0.vec;
+  key->s1plain = key->s2plain = key->t0plain = NULL;
+  key->tr = esk->tr;
+  key->key = esk->key;
+}
+
+/*************************************************
+* Name:        challenge_sample
+*
+* Description: Sample challenge polynomial from SHAKE256 state that has
+*              absorbed mu|w1.
+*
+* Arguments:   - poly *c: pointer to output polynomial
+*              - keccak_state *state: pointer to absorbed SHAKE256 state
+**************************************************/
+static void challenge_sample(poly *c, keccak_state *state) {
   unsigned int i, b, pos;
   uint64_t signs;
-  unsigned char inbuf[CRHBYTES + K*POLW1_SIZE_PACKED];
   unsigned char outbuf[SHAKE256_RATE];
-  keccak_state state;
-
-  for(i = 0; i < CRHBYTES; ++i)
-    inbuf[i] = mu[i];
-  for(i = 0; i < K; ++i)
-    polyw1_pack(inbuf + CRHBYTES + i*POLW1_SIZE_PACKED, &w1->vec[i]);
 
-  shake256_absorb(&state, inbuf, sizeof(inbuf));
-  shake256_squeezeblocks(outbuf, 1, &state);
+  shake256_squeezeblocks(outbuf, 1, state);
 
   signs = 0;
   for(i = 0; i < 8; ++i)
@@ -67,7 +365,7 @@ void challenge(poly *c,
   for(i = 196; i < 256; ++i) {
     do {
       if(pos >= SHAKE256_RATE) {
-        shake256_squeezeblocks(outbuf, 1, &state);
+        shake256_squeezeblocks(outbuf, 1, state);
         pos = 0;
       }
 
@@ -82,18 +380,53 @@ void challenge(poly *c,
 }
 
 /*************************************************
-* Name:        crypto_sign_keypair
+* Name:        challenge
 *
-* Description: Generates public and private key.
+* Description: Implementation of H. Samples polynomial with 60 nonzero
+*              coefficients in {-1,1} using the output stream of
+*              SHAKE256(mu|w1).
+*
+* Arguments:   - poly *c: pointer to output polynomial
+*              - const unsigned char mu[]: byte array containing mu
+*              - const polyveck *w1: pointer to vector w1
+**************************************************/
+void challenge(poly *c,
+               const unsigned char mu[CRHBYTES],
+               const polyveck *w1)
+{
+  unsigned int i;
+  unsigned char inbuf[CRHBYTES + K*POLW1_SIZE_PACKED];
+  keccak_state state;
+
+  for(i = 0; i < CRHBYTES; ++i)
+    inbuf[i] = mu[i];
+  for(i = 0; i < K; ++i)
+    polyw1_pack(inbuf + CRHBYTES + i*POLW1_SIZE_PACKED, &w1->vec[i]);
+
+  shake256_absorb(&state, inbuf, sizeof(inbuf));
+  challenge_sample(c, &state);
+}
+
+/*************************************************
+* Name:        crypto_sign_keypair_parallel
+*
+* Description: Generates public and private key. Expansion of A and the
+*              matrix-vector multiplication are distributed over a thread
+*              pool. Given the same randomness, output is identical to
+*              crypto_sign_keypair.
 *
 * Arguments:   - unsigned char *pk: pointer to output public key (allocated
 *                                   array of CRYPTO_PUBLICKEYBYTES bytes)
 *              - unsigned char *sk: pointer to output private key (allocated
 *                                   array of CRYPTO_SECRETKEYBYTES bytes)
+*              - threadpool *pool: pointer to thread pool, may be NULL
 *
 * Returns 0 (success)
 **************************************************/
-int crypto_sign_keypair(unsigned char *pk, unsigned char *sk) {
+int crypto_sign_keypair_parallel(unsigned char *pk,
+                                 unsigned char *sk,
+                                 threadpool *pool)
+{
   unsigned int i;
   unsigned char seedbuf[3*SEEDBYTES];
   unsigned char tr[CRHBYTES];
@@ -110,7 +443,7 @@ int crypto_sign_keypair(unsigned char *pk, unsigned char *sk) {
   key = seedbuf + 2*SEEDBYTES;
 
   /* Expand matrix */
-  expand_mat(mat, rho);
+  expand_mat_parallel(mat, rho, pool);
 
   /* Sample short vectors s1 and s2 */
   for(i = 0; i < L; ++i)
@@ -121,11 +454,7 @@ int crypto_sign_keypair(unsigned char *pk, unsigned char *sk) {
   /* Matrix-vector multiplication */
   s1hat = s1;
   polyvecl_ntt(&s1hat);
-  for(i = 0; i < K; ++i) {
-    polyvecl_pointwise_acc_invmontgomery(&t.vec[i], &mat[i], &s1hat);
-    poly_reduce(&t.vec[i]);
-    poly_invntt_montgomery(&t.vec[i]);
-  }
+  matmul_parallel(t.vec, mat, &s1hat, pool);
 
   /* Add error vector s2 */
   polyveck_add(&t, &t, &s2);
@@ -143,190 +472,699 @@ int crypto_sign_keypair(unsigned char *pk, unsigned char *sk) {
 }
 
 /*************************************************
-* Name:        crypto_sign
+* Name:        crypto_sign_keypair
 *
-* Description: Compute signed message.
+* Description: Generates public and private key.
 *
-* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
-*                                   array with CRYPTO_BYTES + mlen bytes),
-*                                   can be equal to m
-*              - unsigned long long *smlen: pointer to output length of signed
-*                                           message
-*              - const unsigned char *m: pointer to message to be signed
-*              - unsigned long long mlen: length of message
+* Arguments:   - unsigned char *pk: pointer to output public key (allocated
+*                                   array of CRYPTO_PUBLICKEYBYTES bytes)
+*              - unsigned char *sk: pointer to output private key (allocated
+*                                   array of CRYPTO_SECRETKEYBYTES bytes)
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_keypair(unsigned char *pk, unsigned char *sk) {
+  return crypto_sign_keypair_parallel(pk, sk, NULL);
+}
+
+/*************************************************
+* Name:        crypto_sign_sk_expand_parallel
+*
+* Description: Same as crypto_sign_sk_expand, but expansion of A and the
+*              preparation of s1, s2 and t0 are distributed over a thread
+*              pool.
+*
+* Arguments:   - expanded_sk *esk: pointer to output expanded secret key
 *              - const unsigned char *sk: pointer to bit-packed secret key
+*              - threadpool *pool: pointer to thread pool, may be NULL
 *
 * Returns 0 (success)
 **************************************************/
-int crypto_sign(unsigned char *sm,
-                unsigned long long *smlen,
-                const unsigned char *m,
-                unsigned long long mlen,
-                const unsigned char *sk)
+int crypto_sign_sk_expand_parallel(expanded_sk *esk,
+                                   const unsigned char *sk,
+                                   threadpool *pool)
 {
-  unsigned long long i;
-  unsigned int n;
-  unsigned char seedbuf[2*SEEDBYTES + 3*CRHBYTES];
-  unsigned char *rho, *tr, *key, *mu, *rhoprime;
+  sk_unpack_task t;
+
+  t.p[0] = esk->s1.vec;
+  t.p[1] = esk->s2.vec;
+  t.p[2] = esk->t0.vec;
+  t.sk = sk;
+  sk_expand(esk->mat, esk->tr, esk->key, &t, pool);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_sk_expand
+*
+* Description: Precompute all message-independent parts of signing for a
+*              secret key, i.e. the matrix A and the NTTs of s1, s2 and t0
+*              prepared for multiplication by the challenge.
+*              See sign.h for the size of the expanded key.
+*
+* Arguments:   - expanded_sk *esk: pointer to output expanded secret key
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_sk_expand(expanded_sk *esk, const unsigned char *sk) {
+  return crypto_sign_sk_expand_parallel(esk, sk, NULL);
+}
+
+/*************************************************
+* Name:        compute_mu
+*
+* Description: Compute mu = CRH(tr, msg) without copying the message.
+*
+* Arguments:   - unsigned char mu[]: output byte array for mu
+*              - const unsigned char tr[]: byte array containing tr
+*              - const unsigned char *m: pointer to message
+*              - unsigned long long mlen: length of message
+**************************************************/
+static void compute_mu(unsigned char mu[CRHBYTES],
+                       const unsigned char tr[CRHBYTES],
+                       const unsigned char *m,
+                       unsigned long long mlen)
+{
+  keccak_state state;
+
+  shake256_inc_init(&state);
+  shake256_inc_absorb(&state, tr, CRHBYTES);
+  shake256_inc_absorb(&state, m, mlen);
+  shake256_inc_finalize(&state);
+  shake256_inc_squeeze(mu, CRHBYTES, &state);
+}
+
+/*************************************************
+* Name:        sign_mu
+*
+* Description: Compute signature of message representative mu.
+*
+* Arguments:   - unsigned char sig[]: output byte array for signature
+*              - const unsigned char mu[]: byte array containing mu
+*              - const sign_key *key: pointer to secret key operands
+*              - sign_scratch *s: pointer to scratch space
+*              - threadpool *pool: pointer to thread pool for distributing
+*                                  the polynomial multiplications, may be NULL
+**************************************************/
+static void sign_mu(unsigned char sig[CRYPTO_BYTES],
+                    const unsigned char mu[CRHBYTES],
+                    const sign_key *key,
+                    sign_scratch *s,
+                    threadpool *pool)
+{
+  unsigned int i, n;
+  unsigned char seedbuf[SEEDBYTES + 2*CRHBYTES];
+  unsigned char *rhoprime;
   uint16_t nonce = 0;
   poly c, chat;
-  polyvecl mat[K], s1, y, yhat, z;
-  polyveck t0, s2, w, w1, w0;
-  polyveck h, cs2, ct0;
+  polyvecl *y = &s->y, *yhat = &s->yhat, *z = &s->z;
+  polyveck *w = &s->w, *w1 = &s->w1, *w0 = &s->w0;
+  polyveck *h = &s->h, *cs2 = &s->cs2, *ct0 = &s->ct0;
 
-  rho = seedbuf;
-  tr = rho + SEEDBYTES;
-  key = tr + CRHBYTES;
-  mu = key + SEEDBYTES;
-  rhoprime = mu + CRHBYTES;
-  unpack_sk(rho, key, tr, &s1, &s2, &t0, sk);
-
-  /* Copy tr and message into the sm buffer,
-   * backwards since m and sm can be equal in SUPERCOP API */
-  for(i = 1; i <= mlen; ++i)
-    sm[CRYPTO_BYTES + mlen - i] = m[mlen - i];
+  rhoprime = seedbuf + SEEDBYTES + CRHBYTES;
+  for(i = 0; i < SEEDBYTES; ++i)
+    seedbuf[i] = key->key[i];
   for(i = 0; i < CRHBYTES; ++i)
-    sm[CRYPTO_BYTES - CRHBYTES + i] = tr[i];
-
-  /* Compute CRH(tr, msg) */
-  crh(mu, sm + CRYPTO_BYTES - CRHBYTES, CRHBYTES + mlen);
+    seedbuf[SEEDBYTES + i] = mu[i];
 
 #ifdef RANDOMIZED_SIGNING
   randombytes(rhoprime, CRHBYTES);
 #else
-  crh(rhoprime, key, SEEDBYTES + CRHBYTES);
+  crh(rhoprime, seedbuf, SEEDBYTES + CRHBYTES);
 #endif
 
-  /* Expand matrix and transform vectors */
-  expand_mat(mat, rho);
-  polyvecl_ntt(&s1);
-  polyveck_ntt(&s2);
-  polyveck_ntt(&t0);
+  SIGNSTATS_BEGIN();
 
   rej:
   /* Sample intermediate vector y */
   for(i = 0; i < L; ++i)
-    poly_uniform_gamma1m1(&y.vec[i], rhoprime, nonce++);
+    poly_uniform_gamma1m1(&y->vec[i], rhoprime, nonce++);
 
   /* Matrix-vector multiplication */
-  yhat = y;
-  polyvecl_ntt(&yhat);
-  for(i = 0; i < K; ++i) {
-    polyvecl_pointwise_acc_invmontgomery(&w.vec[i], &mat[i], &yhat);
-    poly_reduce(&w.vec[i]);
-    poly_invntt_montgomery(&w.vec[i]);
-  }
+  *yhat = *y;
+  polyvecl_ntt(yhat);
+  matmul_parallel(w->vec, key->mat, yhat, pool);
 
   /* Decompose w and call the random oracle */
-  polyveck_csubq(&w);
-  polyveck_decompose(&w1, &w0, &w);
-  challenge(&c, mu, &w1);
+  polyveck_csubq(w);
+  polyveck_decompose(w1, w0, w);
+  challenge(&c, mu, w1);
   chat = c;
   poly_ntt(&chat);
 
   /* Check that subtracting cs2 does not change high bits of w and low bits
    * do not reveal secret information */
-  for(i = 0; i < K; ++i) {
-    poly_pointwise_invmontgomery(&cs2.vec[i], &chat, &s2.vec[i]);
-    poly_invntt_montgomery(&cs2.vec[i]);
-  }
-  polyveck_sub(&w0, &w0, &cs2);
-  polyveck_freeze(&w0);
-  if(polyveck_chknorm(&w0, GAMMA2 - BETA))
+  polymul_parallel(cs2->vec, &chat, key->s2, key->s2plain, K, pool);
+  polyveck_sub(w0, w0, cs2);
+  polyveck_freeze(w0);
+  if(polyveck_chknorm(w0, GAMMA2 - BETA)) {
+    SIGNSTATS_REJECT(SIGNSTATS_REJECT_W0);
     goto rej;
+  }
 
   /* Compute z, reject if it reveals secret */
-  for(i = 0; i < L; ++i) {
-    poly_pointwise_invmontgomery(&z.vec[i], &chat, &s1.vec[i]);
-    poly_invntt_montgomery(&z.vec[i]);
-  }
-  polyvecl_add(&z, &z, &y);
-  polyvecl_freeze(&z);
-  if(polyvecl_chknorm(&z, GAMMA1 - BETA))
+  polymul_parallel(z->vec, &chat, key->s1, key->s1plain, L, pool);
+  polyvecl_add(z, z, y);
+  polyvecl_freeze(z);
+  if(polyvecl_chknorm(z, GAMMA1 - BETA)) {
+    SIGNSTATS_REJECT(SIGNSTATS_REJECT_Z);
     goto rej;
+  }
 
   /* Compute hints for w1 */
-  for(i = 0; i < K; ++i) {
-    poly_pointwise_invmontgomery(&ct0.vec[i], &chat, &t0.vec[i]);
-    poly_invntt_montgomery(&ct0.vec[i]);
-  }
+  polymul_parallel(ct0->vec, &chat, key->t0, key->t0plain, K, pool);
 
-  polyveck_csubq(&ct0);
-  if(polyveck_chknorm(&ct0, GAMMA2))
+  polyveck_csubq(ct0);
+  if(polyveck_chknorm(ct0, GAMMA2)) {
+    SIGNSTATS_REJECT(SIGNSTATS_REJECT_CT0);
     goto rej;
+  }
 
-  polyveck_add(&w0, &w0, &ct0);
-  polyveck_csubq(&w0);
-  n = polyveck_make_hint(&h, &w0, &w1);
-  if(n > OMEGA)
+  polyveck_add(w0, w0, ct0);
+  polyveck_csubq(w0);
+  n = polyveck_make_hint(h, w0, w1);
+  if(n > OMEGA) {
+    SIGNSTATS_REJECT(SIGNSTATS_REJECT_HINT);
     goto rej;
+  }
 
-  /* Write signature */
-  pack_sig(sm, &z, &h, &c);
+  SIGNSTATS_ACCEPT();
 
-  *smlen = mlen + CRYPTO_BYTES;
-  return 0;
+  /* Write signature */
+  pack_sig(sig, z, h, &c);
 }
 
 /*************************************************
-* Name:        crypto_sign_open
+* Name:        sign_expanded
 *
-* Description: Verify signed message.
+* Description: Compute signed message using secret key operands and the
+*              given scratch space for the vectors of the signing loop.
 *
-* Arguments:   - unsigned char *m: pointer to output message (allocated
-*                                  array with smlen bytes), can be equal to sm
-*              - unsigned long long *mlen: pointer to output length of message
-*              - const unsigned char *sm: pointer to signed message
-*              - unsigned long long smlen: length of signed message
-*              - const unsigned char *pk: pointer to bit-packed public key
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const sign_key *key: pointer to secret key operands
+*              - sign_scratch *s: pointer to scratch space
+*              - threadpool *pool: pointer to thread pool, may be NULL
 *
-* Returns 0 if signed message could be verified correctly and -1 otherwise
+* Returns 0 (success)
 **************************************************/
-int crypto_sign_open(unsigned char *m,
-                     unsigned long long *mlen,
-                     const unsigned char *sm,
-                     unsigned long long smlen,
-                     const unsigned char *pk)
+static int sign_expanded(unsigned char *sm,
+                         unsigned long long *smlen,
+                         const unsigned char *m,
+                         unsigned long long mlen,
+                         const sign_key *key,
+                         sign_scratch *s,
+                         threadpool *pool)
 {
   unsigned long long i;
-  unsigned char rho[SEEDBYTES];
   unsigned char mu[CRHBYTES];
-  poly c, chat, cp;
-  polyvecl mat[K], z;
-  polyveck t1, w1, h, tmp1, tmp2;
 
-  if(smlen < CRYPTO_BYTES)
-    goto badsig;
+  /* Copy message into the sm buffer,
+   * backwards since m and sm can be equal in SUPERCOP API */
+  for(i = 1; i <= mlen; ++i)
+    sm[CRYPTO_BYTES + mlen - i] = m[mlen - i];
 
-  *mlen = smlen - CRYPTO_BYTES;
+  /* Compute CRH(tr, msg) */
+  compute_mu(mu, key->tr, sm + CRYPTO_BYTES, mlen);
 
-  unpack_pk(rho, &t1, pk);
-  if(unpack_sig(&z, &h, &c, sm))
-    goto badsig;
-  if(polyvecl_chknorm(&z, GAMMA1 - BETA))
-    goto badsig;
+  /* Write signature */
+  sign_mu(sm, mu, key, s, pool);
 
-  /* Compute CRH(CRH(rho, t1), msg) using m as "playground" buffer */
-  if(sm != m)
-    for(i = 0; i < *mlen; ++i)
-      m[CRYPTO_BYTES + i] = sm[CRYPTO_BYTES + i];
+  *smlen = mlen + CRYPTO_BYTES;
+  return 0;
+}
 
-  crh(m + CRYPTO_BYTES - CRHBYTES, pk, CRYPTO_PUBLICKEYBYTES);
-  crh(mu, m + CRYPTO_BYTES - CRHBYTES, CRHBYTES + *mlen);
+/*************************************************
+* Name:        crypto_sign_expanded_parallel
+*
+* Description: Compute signed message using expanded secret key with the
+*              polynomial multiplications distributed over a thread pool.
+*              Output is identical to crypto_sign with the corresponding
+*              secret key.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const expanded_sk *esk: pointer to expanded secret key
+*              - threadpool *pool: pointer to thread pool, may be NULL
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_expanded_parallel(unsigned char *sm,
+                                  unsigned long long *smlen,
+                                  const unsigned char *m,
+                                  unsigned long long mlen,
+                                  const expanded_sk *esk,
+                                  threadpool *pool)
+{
+  sign_key key;
+  sign_scratch s;
 
-  /* Matrix-vector multiplication; compute Az - c2^dt1 */
-  expand_mat(mat, rho);
+  sign_key_expanded(&key, esk);
+  return sign_expanded(sm, smlen, m, mlen, &key, &s, pool);
+}
+
+/*************************************************
+* Name:        crypto_sign_expanded
+*
+* Description: Compute signed message using expanded secret key. Output is
+*              identical to crypto_sign with the corresponding secret key.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const expanded_sk *esk: pointer to expanded secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_expanded(unsigned char *sm,
+                         unsigned long long *smlen,
+                         const unsigned char *m,
+                         unsigned long long mlen,
+                         const expanded_sk *esk)
+{
+  return crypto_sign_expanded_parallel(sm, smlen, m, mlen, esk, NULL);
+}
+
+/*************************************************
+* Name:        crypto_sign_expanded_scratch
+*
+* Description: Compute signed message using expanded secret key, keeping
+*              the vectors of the signing loop in caller-provided scratch
+*              space instead of on the stack. Output is identical to
+*              crypto_sign with the corresponding secret key.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const expanded_sk *esk: pointer to expanded secret key
+*              - sign_scratch *s: pointer to scratch space, not shared with
+*                                 concurrent calls
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_expanded_scratch(unsigned char *sm,
+                                 unsigned long long *smlen,
+                                 const unsigned char *m,
+                                 unsigned long long mlen,
+                                 const expanded_sk *esk,
+                                 sign_scratch *s)
+{
+  sign_key key;
+
+  sign_key_expanded(&key, esk);
+  return sign_expanded(sm, smlen, m, mlen, &key, s, NULL);
+}
+
+/*************************************************
+* Name:        crypto_sign
+*
+* Description: Compute signed message. The secret key is expanded on the
+*              stack without preparing s1, s2 and t0, which does not pay
+*              off for a single signature; use crypto_sign_sk_expand for
+*              long-lived keys. Peak stack usage is about 43, 61, 81 and
+*              103 KiB for modes 1 to 4.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign(unsigned char *sm,
+                unsigned long long *smlen,
+                const unsigned char *m,
+                unsigned long long mlen,
+                const unsigned char *sk)
+{
+  oneshot_sk osk;
+  sign_key key;
+  sign_scratch s;
+
+  oneshot_sk_expand(&osk, &key, sk, NULL);
+  return sign_expanded(sm, smlen, m, mlen, &key, &s, NULL);
+}
+
+/*************************************************
+* Name:        crypto_sign_parallel
+*
+* Description: Compute signed message with key expansion and polynomial
+*              multiplications distributed over a thread pool. Output is
+*              identical to crypto_sign.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*              - threadpool *pool: pointer to thread pool, may be NULL
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_parallel(unsigned char *sm,
+                         unsigned long long *smlen,
+                         const unsigned char *m,
+                         unsigned long long mlen,
+                         const unsigned char *sk,
+                         threadpool *pool)
+{
+  oneshot_sk osk;
+  sign_key key;
+  sign_scratch s;
+
+  oneshot_sk_expand(&osk, &key, sk, pool);
+  return sign_expanded(sm, smlen, m, mlen, &key, &s, pool);
+}
+
+/*************************************************
+* Name:        crypto_sign_signature
+*
+* Description: Compute detached signature. Message is hashed in place, so
+*              no copy of it is made.
+*
+* Arguments:   - unsigned char *sig: pointer to output signature (of length
+*                                    CRYPTO_BYTES)
+*              - unsigned long long *siglen: pointer to output length of
+*                                            signature
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_signature(unsigned char *sig,
+                          unsigned long long *siglen,
+                          const unsigned char *m,
+                          unsigned long long mlen,
+                          const unsigned char *sk)
+{
+  unsigned char mu[CRHBYTES];
+  oneshot_sk osk;
+  sign_key key;
+  sign_scratch s;
+
+  oneshot_sk_expand(&osk, &key, sk, NULL);
+  compute_mu(mu, key.tr, m, mlen);
+  sign_mu(sig, mu, &key, &s, NULL);
+
+  *siglen = CRYPTO_BYTES;
+  return 0;
+}
+
+/*************************************************
+* Name:        sign_mu_lowmem
+*
+* Description: Compute signature of message representative mu directly from
+*              the bit-packed secret key, keeping only w and a few single
+*              polynomials in memory. A and y are sampled anew in every
+*              iteration of the rejection loop; y, s1, s2 and t0 are
+*              sampled or unpacked one polynomial at a time, and z, h and c
+*              are written to the signature as soon as they are known.
+*              Output is identical to sign_mu.
+*
+* Arguments:   - unsigned char sig[]: output byte array for signature
+*              - const unsigned char mu[]: byte array containing mu
+*              - const unsigned char *sk: pointer to bit-packed secret key
+**************************************************/
+static void sign_mu_lowmem(unsigned char sig[CRYPTO_BYTES],
+                           const unsigned char mu[CRHBYTES],
+                           const unsigned char *sk)
+{
+  unsigned int i, j, n;
+  unsigned char seedbuf[SEEDBYTES + 2*CRHBYTES];
+  unsigned char w1buf[K*POLW1_SIZE_PACKED];
+  unsigned char *rhoprime;
+  uint16_t nonce = 0;
+  poly c, chat, a, t;
+  polyveck w;
+  keccak_state state;
+
+  rhoprime = seedbuf + SEEDBYTES + CRHBYTES;
+  for(i = 0; i < SEEDBYTES; ++i)
+    seedbuf[i] = sk[SEEDBYTES + i];
+  for(i = 0; i < CRHBYTES; ++i)
+    seedbuf[SEEDBYTES + i] = mu[i];
+
+#ifdef RANDOMIZED_SIGNING
+  randombytes(rhoprime, CRHBYTES);
+#else
+  crh(rhoprime, seedbuf, SEEDBYTES + CRHBYTES);
+#endif
+
+  SIGNSTATS_BEGIN();
+
+  rej:
+  /* Matrix-vector multiplication column by column; sk starts with rho */
+  for(j = 0; j < L; ++j) {
+    poly_uniform_gamma1m1(&t, rhoprime, nonce++);
+    poly_ntt(&t);
+    for(i = 0; i < K; ++i) {
+      poly_uniform(&a, sk, (i << 8) + j);
+      if(j == 0)
+        poly_pointwise_invmontgomery(&w.vec[i], &a, &t);
+      else {
+        poly_pointwise_invmontgomery(&a, &a, &t);
+        poly_add(&w.vec[i], &w.vec[i], &a);
+      }
+    }
+  }
+
+  /* Decompose w, keeping w0 in place, and call the random oracle */
+  shake256_inc_init(&state);
+  shake256_inc_absorb(&state, mu, CRHBYTES);
+  for(i = 0; i < K; ++i) {
+    poly_reduce(&w.vec[i]);
+    poly_invntt_montgomery(&w.vec[i]);
+    poly_csubq(&w.vec[i]);
+    poly_decompose(&a, &t, &w.vec[i]);
+    w.vec[i] = t;
+    polyw1_pack(w1buf + i*POLW1_SIZE_PACKED, &a);
+  }
+  shake256_inc_absorb(&state, w1buf, sizeof(w1buf));
+  shake256_inc_finalize(&state);
+  challenge_sample(&c, &state);
+  chat = c;
+  poly_ntt(&chat);
+
+  /* Check that subtracting cs2 does not change high bits of w and low bits
+   * do not reveal secret information */
+  for(i = 0; i < K; ++i) {
+    unpack_sk_s2(&t, i, sk);
+    poly_ntt(&t);
+    poly_pointwise_invmontgomery(&t, &chat, &t);
+    poly_invntt_montgomery(&t);
+    poly_sub(&w.vec[i], &w.vec[i], &t);
+    poly_freeze(&w.vec[i]);
+    if(poly_chknorm(&w.vec[i], GAMMA2 - BETA)) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_W0);
+      goto rej;
+    }
+  }
+
+  /* Compute z with y sampled again, reject if it reveals secret */
+  for(j = 0; j < L; ++j) {
+    unpack_sk_s1(&t, j, sk);
+    poly_ntt(&t);
+    poly_pointwise_invmontgomery(&t, &chat, &t);
+    poly_invntt_montgomery(&t);
+    poly_uniform_gamma1m1(&a, rhoprime, nonce - L + j);
+    poly_add(&t, &t, &a);
+    poly_freeze(&t);
+    if(poly_chknorm(&t, GAMMA1 - BETA)) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_Z);
+      goto rej;
+    }
+    pack_sig_z(sig, &t, j);
+  }
+
+  /* Compute hints for w1 */
+  n = 0;
+  for(i = 0; i < K; ++i) {
+    unpack_sk_t0(&t, i, sk);
+    poly_ntt(&t);
+    poly_pointwise_invmontgomery(&t, &chat, &t);
+    poly_invntt_montgomery(&t);
+    poly_csubq(&t);
+    if(poly_chknorm(&t, GAMMA2)) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_CT0);
+      goto rej;
+    }
+
+    poly_add(&w.vec[i], &w.vec[i], &t);
+    poly_csubq(&w.vec[i]);
+    polyw1_unpack(&a, w1buf + i*POLW1_SIZE_PACKED);
+    poly_make_hint(&t, &w.vec[i], &a);
+    n = pack_sig_hint(sig, &t, i, n);
+    if(n > OMEGA) {
+      SIGNSTATS_REJECT(SIGNSTATS_REJECT_HINT);
+      goto rej;
+    }
+  }
+
+  SIGNSTATS_ACCEPT();
+
+  /* Write challenge */
+  pack_sig_c(sig, &c);
+}
+
+/*************************************************
+* Name:        crypto_sign_lowmem
+*
+* Description: Compute signed message like crypto_sign, but without
+*              expanding the secret key. Every iteration of the rejection
+*              loop samples A and y again and unpacks s1, s2 and t0 one
+*              polynomial at a time. This makes signing two to three times
+*              slower in exchange for a peak stack usage including callees
+*              of about 9.4, 10.5, 11.7 and 12.8 KiB for modes 1 to 4,
+*              while the frames of crypto_sign and sign_mu alone take 49,
+*              71, 94 and 119 KiB (GCC 12, -O3). Output is identical to
+*              crypto_sign.
+*
+* Arguments:   - unsigned char *sm: pointer to output signed message (allocated
+*                                   array with CRYPTO_BYTES + mlen bytes),
+*                                   can be equal to m
+*              - unsigned long long *smlen: pointer to output length of signed
+*                                           message
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_lowmem(unsigned char *sm,
+                       unsigned long long *smlen,
+                       const unsigned char *m,
+                       unsigned long long mlen,
+                       const unsigned char *sk)
+{
+  unsigned long long i;
+  unsigned char mu[CRHBYTES];
+
+  /* Copy message into the sm buffer,
+   * backwards since m and sm can be equal in SUPERCOP API */
+  for(i = 1; i <= mlen; ++i)
+    sm[CRYPTO_BYTES + mlen - i] = m[mlen - i];
+
+  /* Compute CRH(tr, msg) */
+  compute_mu(mu, sk + 2*SEEDBYTES, sm + CRYPTO_BYTES, mlen);
+
+  /* Write signature */
+  sign_mu_lowmem(sm, mu, sk);
+
+  *smlen = mlen + CRYPTO_BYTES;
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_signature_lowmem
+*
+* Description: Compute detached signature with the stack usage of
+*              crypto_sign_lowmem.
+*
+* Arguments:   - unsigned char *sig: pointer to output signature (allocated
+*                                    array of CRYPTO_BYTES bytes)
+*              - unsigned long long *siglen: pointer to output length of
+*                                            signature
+*              - const unsigned char *m: pointer to message to be signed
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_signature_lowmem(unsigned char *sig,
+                                 unsigned long long *siglen,
+                                 const unsigned char *m,
+                                 unsigned long long mlen,
+                                 const unsigned char *sk)
+{
+  unsigned char mu[CRHBYTES];
+
+  compute_mu(mu, sk + 2*SEEDBYTES, m, mlen);
+  sign_mu_lowmem(sig, mu, sk);
+
+  *siglen = CRYPTO_BYTES;
+  return 0;
+}
+
+/*************************************************
+* Name:        expand_pk_polys
+*
+* Description: Unpack public key and precompute matrix A and NTT(2^D*t1).
+*              Leaves tr untouched.
+*
+* Arguments:   - expanded_pk *epk: pointer to output expanded public key
+*              - const unsigned char *pk: pointer to bit-packed public key
+**************************************************/
+static void expand_pk_polys(expanded_pk *epk, const unsigned char *pk) {
+  unsigned char rho[SEEDBYTES];
+
+  unpack_pk(rho, &epk->t1, pk);
+  matcache_expand_mat(epk->mat, rho);
+  polyveck_shiftl(&epk->t1);
+  polyveck_ntt(&epk->t1);
+}
+
+/*************************************************
+* Name:        verify_mu
+*
+* Description: Verify signature on message representative mu.
+*
+* Arguments:   - const unsigned char *sig: pointer to signature
+*              - const unsigned char mu[]: byte array containing mu
+*              - const expanded_pk *epk: pointer to expanded public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+static int verify_mu(const unsigned char *sig,
+                     const unsigned char mu[CRHBYTES],
+                     const expanded_pk *epk)
+{
+  unsigned int i;
+  poly c, chat, cp;
+  polyvecl z;
+  polyveck w1, h, tmp1, tmp2;
+
+  if(unpack_sig(&z, &h, &c, sig))
+    return -1;
+  if(polyvecl_chknorm(&z, GAMMA1 - BETA))
+    return -1;
 
+  /* Matrix-vector multiplication; compute Az - c2^dt1 */
   polyvecl_ntt(&z);
   for(i = 0; i < K ; ++i)
-    polyvecl_pointwise_acc_invmontgomery(&tmp1.vec[i], &mat[i], &z);
+    polyvecl_pointwise_acc_invmontgomery(&tmp1.vec[i], &epk->mat[i], &z);
 
   chat = c;
   poly_ntt(&chat);
-  polyveck_shiftl(&t1);
-  polyveck_ntt(&t1);
   for(i = 0; i < K; ++i)
-    poly_pointwise_invmontgomery(&tmp2.vec[i], &chat, &t1.vec[i]);
+    poly_pointwise_invmontgomery(&tmp2.vec[i], &chat, &epk->t1.vec[i]);
 
   polyveck_sub(&tmp1, &tmp1, &tmp2);
   polyveck_reduce(&tmp1);
@@ -340,7 +1178,258 @@ int crypto_sign_open(unsigned char *m,
   challenge(&cp, mu, &w1);
   for(i = 0; i < N; ++i)
     if(c.coeffs[i] != cp.coeffs[i])
-      goto badsig;
+      return -1;
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_pk_expand
+*
+* Description: Precompute all message-independent parts of verification for
+*              a public key, i.e. the matrix A, NTT(2^D*t1) and tr = CRH(pk).
+*              See sign.h for the size of the expanded key.
+*
+* Arguments:   - expanded_pk *epk: pointer to output expanded public key
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_pk_expand(expanded_pk *epk, const unsigned char *pk) {
+  expand_pk_polys(epk, pk);
+  crh(epk->tr, pk, CRYPTO_PUBLICKEYBYTES);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_open_expanded
+*
+* Description: Verify signed message using expanded public key.
+*
+* Arguments:   - unsigned char *m: pointer to output message (allocated
+*                                  array with smlen bytes), can be equal to sm
+*              - unsigned long long *mlen: pointer to output length of message
+*              - const unsigned char *sm: pointer to signed message
+*              - unsigned long long smlen: length of signed message
+*              - const expanded_pk *epk: pointer to expanded public key
+*
+* Returns 0 if signed message could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_open_expanded(unsigned char *m,
+                              unsigned long long *mlen,
+                              const unsigned char *sm,
+                              unsigned long long smlen,
+                              const expanded_pk *epk)
+{
+  unsigned long long i;
+  unsigned char mu[CRHBYTES];
+
+  if(smlen < CRYPTO_BYTES)
+    goto badsig;
+
+  *mlen = smlen - CRYPTO_BYTES;
+
+  /* Compute CRH(CRH(rho, t1), msg) */
+  compute_mu(mu, epk->tr, sm + CRYPTO_BYTES, *mlen);
+
+  if(verify_mu(sm, mu, epk))
+    goto badsig;
+
+  /* All good, copy msg, return 0 */
+  for(i = 0; i < *mlen; ++i)
+    m[i] = sm[CRYPTO_BYTES + i];
+
+  return 0;
+
+  /* Signature verification failed */
+  badsig:
+  *mlen = (unsigned long long) -1;
+  for(i = 0; i < smlen; ++i)
+    m[i] = 0;
+
+  return -1;
+}
+
+/*************************************************
+* Name:        crypto_sign_open
+*
+* Description: Verify signed message.
+*
+* Arguments:   - unsigned char *m: pointer to output message (allocated
+*                                  array with smlen bytes), can be equal to sm
+*              - unsigned long long *mlen: pointer to output length of message
+*              - const unsigned char *sm: pointer to signed message
+*              - unsigned long long smlen: length of signed message
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 if signed message could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_open(unsigned char *m,
+                     unsigned long long *mlen,
+                     const unsigned char *sm,
+                     unsigned long long smlen,
+                     const unsigned char *pk)
+{
+  unsigned long long i;
+  expanded_pk epk;
+
+  /* Reject truncated input before paying for the key expansion */
+  if(smlen < CRYPTO_BYTES) {
+    *mlen = (unsigned long long) -1;
+    for(i = 0; i < smlen; ++i)
+      m[i] = 0;
+    return -1;
+  }
+
+  crypto_sign_pk_expand(&epk, pk);
+  return crypto_sign_open_expanded(m, mlen, sm, smlen, &epk);
+}
+
+/*************************************************
+* Name:        crypto_sign_verify
+*
+* Description: Verify detached signature. Message is hashed in place, so
+*              no copy of it is made.
+*
+* Arguments:   - const unsigned char *sig: pointer to signature
+*              - unsigned long long siglen: length of signature
+*              - const unsigned char *m: pointer to message
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify(const unsigned char *sig,
+                       unsigned long long siglen,
+                       const unsigned char *m,
+                       unsigned long long mlen,
+                       const unsigned char *pk)
+{
+  unsigned char mu[CRHBYTES];
+  expanded_pk epk;
+
+  if(siglen != CRYPTO_BYTES)
+    return -1;
+
+  crypto_sign_pk_expand(&epk, pk);
+  compute_mu(mu, epk.tr, m, mlen);
+  return verify_mu(sig, mu, &epk);
+}
+
+/*************************************************
+* Name:        verify_mu_lowmem
+*
+* Description: Verify signature on message representative mu without
+*              storing A, t1 or h. Every polynomial of A is generated and
+*              multiplied into its row of Az right away, and each row of w1
+*              is absorbed into the challenge hash as soon as it is known.
+*
+* Arguments:   - const unsigned char *sig: pointer to signature
+*              - const unsigned char mu[]: byte array containing mu
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+static int verify_mu_lowmem(const unsigned char *sig,
+                            const unsigned char mu[CRHBYTES],
+                            const unsigned char *pk)
+{
+  unsigned int i, j;
+  unsigned char buf[POLW1_SIZE_PACKED];
+  poly c, chat, a, w, t;
+  polyvecl z;
+  keccak_state state;
+
+  if(unpack_sig_zc(&z, &c, sig))
+    return -1;
+  if(polyvecl_chknorm(&z, GAMMA1 - BETA))
+    return -1;
+
+  polyvecl_ntt(&z);
+  chat = c;
+  poly_ntt(&chat);
+
+  shake256_inc_init(&state);
+  shake256_inc_absorb(&state, mu, CRHBYTES);
+
+  for(i = 0; i < K; ++i) {
+    /* Row i of Az; pk starts with rho */
+    poly_uniform(&a, pk, (i << 8));
+    poly_pointwise_invmontgomery(&w, &a, &z.vec[0]);
+    for(j = 1; j < L; ++j) {
+      poly_uniform(&a, pk, (i << 8) + j);
+      poly_pointwise_invmontgomery(&a, &a, &z.vec[j]);
+      poly_add(&w, &w, &a);
+    }
+
+    /* Subtract c2^dt1 */
+    polyt1_unpack(&t, pk + SEEDBYTES + i*POLT1_SIZE_PACKED);
+    poly_shiftl(&t);
+    poly_ntt(&t);
+    poly_pointwise_invmontgomery(&t, &chat, &t);
+    poly_sub(&w, &w, &t);
+    poly_reduce(&w);
+    poly_invntt_montgomery(&w);
+
+    /* Reconstruct row i of w1 and absorb it */
+    poly_csubq(&w);
+    unpack_sig_hint(&t, i, sig);
+    poly_use_hint(&a, &w, &t);
+    polyw1_pack(buf, &a);
+    shake256_inc_absorb(&state, buf, POLW1_SIZE_PACKED);
+  }
+
+  /* Call random oracle and verify challenge */
+  shake256_inc_finalize(&state);
+  challenge_sample(&a, &state);
+  for(i = 0; i < N; ++i)
+    if(c.coeffs[i] != a.coeffs[i])
+      return -1;
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_open_lowmem
+*
+* Description: Verify signed message like crypto_sign_open, but without
+*              expanding the public key. Neither A nor any full vector of
+*              length K is kept in memory. Peak stack usage including callees
+*              is about 9, 10, 11 and 12 KiB for modes 1 to 4, while the
+*              frame of crypto_sign_open alone takes 10, 17, 26 and 37 KiB
+*              (GCC 12, -O3). A is generated anew on every call.
+*
+* Arguments:   - unsigned char *m: pointer to output message (allocated
+*                                  array with smlen bytes), can be equal to sm
+*              - unsigned long long *mlen: pointer to output length of message
+*              - const unsigned char *sm: pointer to signed message
+*              - unsigned long long smlen: length of signed message
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 if signed message could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_open_lowmem(unsigned char *m,
+                            unsigned long long *mlen,
+                            const unsigned char *sm,
+                            unsigned long long smlen,
+                            const unsigned char *pk)
+{
+  unsigned long long i;
+  unsigned char tr[CRHBYTES];
+  unsigned char mu[CRHBYTES];
+
+  if(smlen < CRYPTO_BYTES)
+    goto badsig;
+
+  *mlen = smlen - CRYPTO_BYTES;
+
+  /* Compute CRH(CRH(rho, t1), msg) */
+  crh(tr, pk, CRYPTO_PUBLICKEYBYTES);
+  compute_mu(mu, tr, sm + CRYPTO_BYTES, *mlen);
+
+  if(verify_mu_lowmem(sm, mu, pk))
+    goto badsig;
 
   /* All good, copy msg, return 0 */
   for(i = 0; i < *mlen; ++i)
@@ -356,3 +1445,225 @@ int crypto_sign_open(unsigned char *m,
 
   return -1;
 }
+
+/*************************************************
+* Name:        crypto_sign_verify_lowmem
+*
+* Description: Verify detached signature with the stack usage of
+*              crypto_sign_open_lowmem.
+*
+* Arguments:   - const unsigned char *sig: pointer to signature
+*              - unsigned long long siglen: length of signature
+*              - const unsigned char *m: pointer to message
+*              - unsigned long long mlen: length of message
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify_lowmem(const unsigned char *sig,
+                              unsigned long long siglen,
+                              const unsigned char *m,
+                              unsigned long long mlen,
+                              const unsigned char *pk)
+{
+  unsigned char tr[CRHBYTES];
+  unsigned char mu[CRHBYTES];
+
+  if(siglen != CRYPTO_BYTES)
+    return -1;
+
+  crh(tr, pk, CRYPTO_PUBLICKEYBYTES);
+  compute_mu(mu, tr, m, mlen);
+  return verify_mu_lowmem(sig, mu, pk);
+}
+
+/*************************************************
+* Name:        crypto_sign_open_batch
+*
+* Description: Verify n signed messages under possibly different public keys.
+*              Output buffers behave exactly as for crypto_sign_open.
+*
+* Arguments:   - unsigned long long n: number of signed messages
+*              - const unsigned char *pk[]: array of pointers to public keys
+*              - const unsigned char *sm[]: array of pointers to signed
+*                                           messages
+*              - const unsigned long long smlen[]: array of lengths of signed
+*                                                  messages
+*              - unsigned char *m[]: array of pointers to output messages
+*                                    (allocated arrays with smlen[i] bytes),
+*                                    m[i] can be equal to sm[i]
+*              - unsigned long long mlen[]: array of output message lengths
+*              - int results[]: array of per-signature results, 0 if signed
+*                               message could be verified correctly and -1
+*                               otherwise
+*
+* Returns 0 if all signed messages could be verified and -1 otherwise
+**************************************************/
+int crypto_sign_open_batch(unsigned long long n,
+                           const unsigned char *pk[],
+                           const unsigned char *sm[],
+                           const unsigned long long smlen[],
+                           unsigned char *m[],
+                           unsigned long long mlen[],
+                           int results[])
+{
+  unsigned long long i;
+  int ret = 0;
+
+  for(i = 0; i < n; ++i) {
+    results[i] = crypto_sign_open(m[i], &mlen[i], sm[i], smlen[i], pk[i]);
+    ret |= results[i];
+  }
+
+  return ret;
+}
+
+/*************************************************
+* Name:        crypto_sign_init
+*
+* Description: Start incremental signing of a message that is passed to
+*              crypto_sign_update in pieces. The signature output by
+*              crypto_sign_final is identical to the first CRYPTO_BYTES
+*              bytes of the signed message produced by crypto_sign.
+*
+* Arguments:   - sign_state *state: pointer to output state
+*              - const unsigned char *sk: pointer to bit-packed secret key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_init(sign_state *state, const unsigned char *sk) {
+  shake256_inc_init(&state->mu);
+  shake256_inc_absorb(&state->mu, sk + 2*SEEDBYTES, CRHBYTES);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_update
+*
+* Description: Absorb next piece of message to be signed.
+*
+* Arguments:   - sign_state *state: pointer to state
+*              - const unsigned char *m: pointer to message piece
+*              - unsigned long long mlen: length of message piece
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_update(sign_state *state,
+                       const unsigned char *m,
+                       unsigned long long mlen)
+{
+  shake256_inc_absorb(&state->mu, m, mlen);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_final
+*
+* Description: Compute signature of all message pieces absorbed into state.
+*              The state must not be used afterwards without calling
+*              crypto_sign_init again.
+*
+* Arguments:   - unsigned char *sig: pointer to output signature (of length
+*                                    CRYPTO_BYTES)
+*              - unsigned long long *siglen: pointer to output length of
+*                                            signature
+*              - sign_state *state: pointer to state
+*              - const unsigned char *sk: pointer to bit-packed secret key,
+*                                         must match crypto_sign_init
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_final(unsigned char *sig,
+                      unsigned long long *siglen,
+                      sign_state *state,
+                      const unsigned char *sk)
+{
+  unsigned char mu[CRHBYTES];
+  oneshot_sk osk;
+  sign_key key;
+  sign_scratch s;
+
+  shake256_inc_finalize(&state->mu);
+  shake256_inc_squeeze(mu, CRHBYTES, &state->mu);
+
+  oneshot_sk_expand(&osk, &key, sk, NULL);
+  sign_mu(sig, mu, &key, &s, NULL);
+
+  *siglen = CRYPTO_BYTES;
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_init
+*
+* Description: Start incremental verification of a message that is passed
+*              to crypto_sign_verify_update in pieces.
+*
+* Arguments:   - sign_state *state: pointer to output state
+*              - const unsigned char *pk: pointer to bit-packed public key
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_verify_init(sign_state *state, const unsigned char *pk) {
+  unsigned char tr[CRHBYTES];
+
+  crh(tr, pk, CRYPTO_PUBLICKEYBYTES);
+  shake256_inc_init(&state->mu);
+  shake256_inc_absorb(&state->mu, tr, CRHBYTES);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_update
+*
+* Description: Absorb next piece of message to be verified.
+*
+* Arguments:   - sign_state *state: pointer to state
+*              - const unsigned char *m: pointer to message piece
+*              - unsigned long long mlen: length of message piece
+*
+* Returns 0 (success)
+**************************************************/
+int crypto_sign_verify_update(sign_state *state,
+                              const unsigned char *m,
+                              unsigned long long mlen)
+{
+  shake256_inc_absorb(&state->mu, m, mlen);
+
+  return 0;
+}
+
+/*************************************************
+* Name:        crypto_sign_verify_final
+*
+* Description: Verify signature on all message pieces absorbed into state.
+*
+* Arguments:   - sign_state *state: pointer to state
+*              - const unsigned char *sig: pointer to signature
+*              - unsigned long long siglen: length of signature
+*              - const unsigned char *pk: pointer to bit-packed public key,
+*                                         must match crypto_sign_verify_init
+*
+* Returns 0 if signature could be verified correctly and -1 otherwise
+**************************************************/
+int crypto_sign_verify_final(sign_state *state,
+                             const unsigned char *sig,
+                             unsigned long long siglen,
+                             const unsigned char *pk)
+{
+  unsigned char mu[CRHBYTES];
+  expanded_pk epk;
+
+  shake256_inc_finalize(&state->mu);
+  shake256_inc_squeeze(mu, CRHBYTES, &state->mu);
+
+  if(siglen != CRYPTO_BYTES)
+    return -1;
+
+  /* tr was already absorbed in crypto_sign_verify_init */
+  expand_pk_polys(&epk, pk);
+  return verify_mu(sig, mu, &epk);
+}
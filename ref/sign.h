@@ -4,19 +4,141 @@
 #include "params.h"
 #include "poly.h"
 #include "polyvec.h"
+#include "fips202.h"
+#include "threadpool.h"
+
+/*
+ * Expanded public key holding A, NTT(2^D*t1) and tr = CRH(pk). Its size
+ * is sizeof(expanded_pk) = 1024*K*(L + 1) + 64 bytes, i.e. 9280, 16448,
+ * 25664 and 36928 bytes for modes 1 to 4.
+ */
+typedef struct {
+  polyvecl mat[K];
+  polyveck t1;
+  unsigned char tr[CRHBYTES];
+} expanded_pk;
+
+/*
+ * Expanded secret key holding A, NTT(s1), NTT(s2) and NTT(t0) prepared for
+ * multiplication by the challenge, tr and key. Its size is
+ * sizeof(expanded_sk) = 1024*(K*L + 2*L + 4*K) + 96 bytes, i.e. 22624,
+ * 34912, 49248 and 65632 bytes for modes 1 to 4. The one-shot signing
+ * functions do not use it and skip the preparation.
+ */
+typedef struct {
+  polyvecl mat[K];
+  polyvecl_prepared s1;
+  polyveck_prepared s2;
+  polyveck_prepared t0;
+  unsigned char tr[CRHBYTES];
+  unsigned char key[SEEDBYTES];
+} expanded_sk;
+
+/*
+ * Scratch space holding the vectors of the signing loop. Callers that sign
+ * many messages on one thread, like the batch signing workers, keep one
+ * per thread instead of setting up a fresh stack frame of
+ * 1024*(3*L + 6*K) bytes, 42 and 51 KiB in modes 3 and 4, for every
+ * signature.
+ */
+typedef struct {
+  polyvecl y, yhat, z;
+  polyveck w, w1, w0, h, cs2, ct0;
+} sign_scratch;
+
+/*
+ * State for incremental signing and verification of messages that are
+ * streamed in pieces; holds the running CRH(tr, msg) computation.
+ */
+typedef struct {
+  keccak_state mu;
+} sign_state;
 
 void expand_mat(polyvecl mat[K], const unsigned char rho[SEEDBYTES]);
 void challenge(poly *c, const unsigned char mu[CRHBYTES],
                const polyveck *w1);
 
 int crypto_sign_keypair(unsigned char *pk, unsigned char *sk);
+int crypto_sign_keypair_parallel(unsigned char *pk, unsigned char *sk,
+                                 threadpool *pool);
 
 int crypto_sign(unsigned char *sm, unsigned long long *smlen,
                 const unsigned char *msg, unsigned long long len,
                 const unsigned char *sk);
+int crypto_sign_signature(unsigned char *sig, unsigned long long *siglen,
+                          const unsigned char *m, unsigned long long mlen,
+                          const unsigned char *sk);
+
+int crypto_sign_sk_expand(expanded_sk *esk, const unsigned char *sk);
+int crypto_sign_expanded(unsigned char *sm, unsigned long long *smlen,
+                         const unsigned char *msg, unsigned long long len,
+                         const expanded_sk *esk);
+int crypto_sign_expanded_scratch(unsigned char *sm, unsigned long long *smlen,
+                                 const unsigned char *msg,
+                                 unsigned long long len,
+                                 const expanded_sk *esk, sign_scratch *s);
+
+int crypto_sign_parallel(unsigned char *sm, unsigned long long *smlen,
+                         const unsigned char *msg, unsigned long long len,
+                         const unsigned char *sk, threadpool *pool);
+int crypto_sign_sk_expand_parallel(expanded_sk *esk, const unsigned char *sk,
+                                   threadpool *pool);
+int crypto_sign_expanded_parallel(unsigned char *sm, unsigned long long *smlen,
+                                  const unsigned char *msg,
+                                  unsigned long long len,
+                                  const expanded_sk *esk, threadpool *pool);
+
+int crypto_sign_lowmem(unsigned char *sm, unsigned long long *smlen,
+                       const unsigned char *m, unsigned long long mlen,
+                       const unsigned char *sk);
+int crypto_sign_signature_lowmem(unsigned char *sig,
+                                 unsigned long long *siglen,
+                                 const unsigned char *m,
+                                 unsigned long long mlen,
+                                 const unsigned char *sk);
 
 int crypto_sign_open(unsigned char *m, unsigned long long *mlen,
                      const unsigned char *sm, unsigned long long smlen,
                      const unsigned char *pk);
+int crypto_sign_verify(const unsigned char *sig, unsigned long long siglen,
+                       const unsigned char *m, unsigned long long mlen,
+                       const unsigned char *pk);
+
+int crypto_sign_pk_expand(expanded_pk *epk, const unsigned char *pk);
+int crypto_sign_open_expanded(unsigned char *m, unsigned long long *mlen,
+                              const unsigned char *sm,
+                              unsigned long long smlen,
+                              const expanded_pk *epk);
+
+int crypto_sign_open_lowmem(unsigned char *m, unsigned long long *mlen,
+                            const unsigned char *sm, unsigned long long smlen,
+                            const unsigned char *pk);
+int crypto_sign_verify_lowmem(const unsigned char *sig,
+                              unsigned long long siglen,
+                              const unsigned char *m, unsigned long long mlen,
+                              const unsigned char *pk);
+
+int crypto_sign_open_batch(unsigned long long n,
+                           const unsigned char *pk[],
+                           const unsigned char *sm[],
+                           const unsigned long long smlen[],
+                           unsigned char *m[],
+                           unsigned long long mlen[],
+                           int results[]);
+
+int crypto_sign_init(sign_state *state, const unsigned char *sk);
+int crypto_sign_update(sign_state *state,
+                       const unsigned char *m, unsigned long long mlen);
+int crypto_sign_final(unsigned char *sig, unsigned long long *siglen,
+                      sign_state *state, const unsigned char *sk);
+
+int crypto_sign_verify_init(sign_state *state, const unsigned char *pk);
+int crypto_sign_verify_update(sign_state *state,
+                              const unsigned char *m,
+                              unsigned long long mlen);
+int crypto_sign_verify_final(sign_state *state,
+                             const unsigned char *sig,
+                             unsigned long long siglen,
+                             const unsigned char *pk);
 
 #endif
@@ -0,0 +1,276 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "params.h"
+#include "sign.h"
+#include "threadpool.h"
+#include "signbatch.h"
+
+/*
+ * Work-stealing engine for signing many messages with a few keys. Jobs are
+ * split into contiguous ranges, one per thread of the pool. A thread takes
+ * jobs from the front of its own range; once it is empty it steals the back
+ * half of the range of another thread. Each range is a single 64-bit word
+ * (begin in the low and end in the high half) updated with compare-and-swap.
+ * Every thread owns an expanded secret key as scratch space and only expands
+ * again when the key of the next job differs from the previous one; keys are
+ * compared in constant time. It also owns the vectors of the signing loop,
+ * so a signature does not set up tens of KiB of fresh stack. All worker
+ * state is erased before it is freed.
+ */
+
+typedef struct {
+  uint64_t range;
+} __attribute__((aligned(64))) batch_queue;
+
+typedef struct {
+  expanded_sk esk;
+  sign_scratch scratch;
+  const unsigned char *sk;
+  sign_batch_stats stats;
+} __attribute__((aligned(64))) batch_worker;
+
+typedef struct {
+  unsigned char **sm;
+  unsigned long long *smlen;
+  const unsigned char **m;
+  const unsigned long long *mlen;
+  const unsigned char **sk;
+  unsigned int nworkers;
+  batch_queue queues[THREADPOOL_MAX_THREADS + 1];
+  batch_worker *workers;
+} batch_ctx;
+
+/*************************************************
+* Name:        batch_pop
+*
+* Description: Take job from the front of a thread's own range.
+*
+* Arguments:   - batch_queue *q: pointer to range of calling thread
+*              - uint32_t *job: pointer to output job index
+*
+* Returns 1 if a job was taken and 0 if the range is empty
+**************************************************/
+static int batch_pop(batch_queue *q, uint32_t *job) {
+  uint32_t b, e;
+  uint64_t r;
+
+  r = __atomic_load_n(&q->range, __ATOMIC_RELAXED);
+  do {
+    b = (uint32_t)r;
+    e = (uint32_t)(r >> 32);
+    if(b >= e)
+      return 0;
+  } while(!__atomic_compare_exchange_n(&q->range, &r,
+                                       ((uint64_t)e << 32) | (b + 1), 1,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+  *job = b;
+  return 1;
+}
+
+/*************************************************
+* Name:        batch_steal
+*
+* Description: Move back half of another thread's range into the empty range
+*              of the calling thread.
+*
+* Arguments:   - batch_queue *own: pointer to empty range of calling thread
+*              - batch_queue *victim: pointer to range to steal from
+*
+* Returns 1 if jobs were stolen and 0 if the victim's range is empty
+**************************************************/
+static int batch_steal(batch_queue *own, batch_queue *victim) {
+  uint32_t b, e, k;
+  uint64_t r;
+
+  r = __atomic_load_n(&victim->range, __ATOMIC_RELAXED);
+  do {
+    b = (uint32_t)r;
+    e = (uint32_t)(r >> 32);
+    if(b >= e)
+      return 0;
+    k = (e - b + 1)/2;
+  } while(!__atomic_compare_exchange_n(&victim->range, &r,
+                                       ((uint64_t)(e - k) << 32) | b, 1,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+  __atomic_store_n(&own->range, ((uint64_t)e << 32) | (e - k),
+                   __ATOMIC_RELEASE);
+  return 1;
+}
+
+/*************************************************
+* Name:        batch_sk_differs
+*
+* Description: Compare two bit-packed secret keys in constant time.
+*
+* Arguments:   - const unsigned char *a: pointer to first secret key
+*              - const unsigned char *b: pointer to second secret key
+*
+* Returns 0 if the keys are equal and 1 otherwise
+**************************************************/
+static int batch_sk_differs(const unsigned char *a, const unsigned char *b) {
+  unsigned int i;
+  unsigned char r = 0;
+
+  for(i = 0; i < CRYPTO_SECRETKEYBYTES; ++i)
+    r |= a[i] ^ b[i];
+
+  return (-(uint32_t)r) >> 31;
+}
+
+/*************************************************
+* Name:        batch_erase
+*
+* Description: Zero memory holding secret data in a way the compiler does
+*              not remove before the memory is freed.
+*
+* Arguments:   - void *p: pointer to memory
+*              - size_t len: number of bytes
+**************************************************/
+static void batch_erase(void *p, size_t len) {
+  volatile unsigned char *v = p;
+
+  while(len--)
+    *v++ = 0;
+}
+
+/*************************************************
+* Name:        batch_sign_job
+*
+* Description: Sign one job, expanding its secret key into the scratch space
+*              of the calling thread unless it is already there.
+*
+* Arguments:   - batch_ctx *ctx: pointer to batch context
+*              - batch_worker *w: pointer to scratch space of calling thread
+*              - uint32_t i: job index
+**************************************************/
+static void batch_sign_job(batch_ctx *ctx, batch_worker *w, uint32_t i) {
+  const unsigned char *sk = ctx->sk[i];
+
+  if(!w->sk || (w->sk != sk && batch_sk_differs(w->sk, sk))) {
+    crypto_sign_sk_expand(&w->esk, sk);
+    ++w->stats.expansions;
+  }
+  w->sk = sk;
+
+  crypto_sign_expanded_scratch(ctx->sm[i], &ctx->smlen[i], ctx->m[i],
+                               ctx->mlen[i], &w->esk, &w->scratch);
+  ++w->stats.signatures;
+  w->stats.bytes += ctx->mlen[i];
+}
+
+/*************************************************
+* Name:        batch_worker_run
+*
+* Description: Main loop of thread t; runs until all ranges are empty.
+*
+* Arguments:   - void *arg: pointer to batch context
+*              - unsigned int t: thread index
+**************************************************/
+static void batch_worker_run(void *arg, unsigned int t) {
+  unsigned int i;
+  uint32_t job;
+  batch_ctx *ctx = arg;
+  batch_queue *own = &ctx->queues[t];
+  batch_worker *w = &ctx->workers[t];
+
+  for(;;) {
+    while(batch_pop(own, &job))
+      batch_sign_job(ctx, w, job);
+
+    for(i = 1; i < ctx->nworkers; ++i)
+      if(batch_steal(own, &ctx->queues[(t + i) % ctx->nworkers]))
+        break;
+
+    if(i == ctx->nworkers)
+      return;
+    ++w->stats.steals;
+  }
+}
+
+/*************************************************
+* Name:        crypto_sign_batch
+*
+* Description: Compute n signed messages on the threads of a pool. Job i
+*              signs m[i] with sk[i]; the keys may repeat. Output is
+*              identical to calling crypto_sign for every job.
+*
+* Arguments:   - unsigned long long n: number of jobs, less than 2^32
+*              - unsigned char *sm[]: array of pointers to output signed
+*                                     messages, each with CRYPTO_BYTES +
+*                                     mlen[i] bytes
+*              - unsigned long long smlen[]: array of output lengths of
+*                                            signed messages
+*              - const unsigned char *m[]: array of pointers to messages
+*              - const unsigned long long mlen[]: array of message lengths
+*              - const unsigned char *sk[]: array of pointers to bit-packed
+*                                           secret keys
+*              - threadpool *pool: pointer to thread pool, may be NULL
+*              - sign_batch_stats *stats: pointer to output statistics, may
+*                                         be NULL
+*
+* Returns 0 on success and -1 if scratch space could not be allocated
+**************************************************/
+int crypto_sign_batch(unsigned long long n,
+                      unsigned char *sm[],
+                      unsigned long long smlen[],
+                      const unsigned char *m[],
+                      const unsigned long long mlen[],
+                      const unsigned char *sk[],
+                      threadpool *pool,
+                      sign_batch_stats *stats)
+{
+  unsigned int i;
+  uint64_t b, e;
+  struct timespec start, stop;
+  batch_ctx ctx;
+
+  if(n >> 32)
+    return -1;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  ctx.sm = sm;
+  ctx.smlen = smlen;
+  ctx.m = m;
+  ctx.mlen = mlen;
+  ctx.sk = sk;
+  ctx.nworkers = (pool ? pool->nthreads : 0) + 1;
+  if(ctx.nworkers > n)
+    ctx.nworkers = n ? n : 1;
+
+  ctx.workers = aligned_alloc(64, ctx.nworkers*sizeof(batch_worker));
+  if(!ctx.workers)
+    return -1;
+
+  for(i = 0; i < ctx.nworkers; ++i) {
+    b = n*i/ctx.nworkers;
+    e = n*(i + 1)/ctx.nworkers;
+    ctx.queues[i].range = (e << 32) | b;
+    ctx.workers[i].sk = NULL;
+    memset(&ctx.workers[i].stats, 0, sizeof(sign_batch_stats));
+  }
+
+  threadpool_run(pool, batch_worker_run, &ctx, ctx.nworkers);
+
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+
+  if(stats) {
+    memset(stats, 0, sizeof(sign_batch_stats));
+    for(i = 0; i < ctx.nworkers; ++i) {
+      stats->signatures += ctx.workers[i].stats.signatures;
+      stats->bytes += ctx.workers[i].stats.bytes;
+      stats->expansions += ctx.workers[i].stats.expansions;
+      stats->steals += ctx.workers[i].stats.steals;
+    }
+    stats->nsecs = (stop.tv_sec - start.tv_sec)*1000000000ULL
+                   + stop.tv_nsec - start.tv_nsec;
+  }
+
+  batch_erase(ctx.workers, ctx.nworkers*sizeof(batch_worker));
+  free(ctx.workers);
+  return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef SIGNBATCH_H
+#define SIGNBATCH_H
+
+#include "params.h"
+#include "sign.h"
+#include "threadpool.h"
+
+typedef struct {
+  unsigned long long signatures;
+  unsigned long long bytes;
+  unsigned long long expansions;
+  unsigned long long steals;
+  unsigned long long nsecs;
+} sign_batch_stats;
+
+int crypto_sign_batch(unsigned long long n,
+                      unsigned char *sm[],
+                      unsigned long long smlen[],
+                      const unsigned char *m[],
+                      const unsigned long long mlen[],
+                      const unsigned char *sk[],
+                      threadpool *pool,
+                      sign_batch_stats *stats);
+
+#endif
@@ -0,0 +1,214 @@
+#include <string.h>
+#include <pthread.h>
+#include "signstats.h"
+
+/*
+ * Telemetry of the rejection loop in signing, compiled in with SIGN_STATS.
+ * Statistics are kept per thread, so recording never contends; a thread
+ * only bumps counters on its own record with relaxed atomics. On first use
+ * every record is linked into a global list so signstats_get_all can sum
+ * the statistics of all threads, including thread pool and batch signing
+ * workers. When a thread exits, its counts are folded into a retired total
+ * and the record is unlinked.
+ */
+
+typedef struct signstats_record {
+  signstats stats;
+  int registered;
+  struct signstats_record *next;
+} signstats_record;
+
+static __thread signstats_record stats_tls;
+static signstats_record *stats_list;
+static signstats stats_retired;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t stats_key;
+
+/*************************************************
+* Name:        signstats_add
+*
+* Description: Add the counters of one statistics record to another.
+*
+* Arguments:   - signstats *r: pointer to output statistics
+*              - const signstats *a: pointer to statistics to be added
+**************************************************/
+static void signstats_add(signstats *r, const signstats *a) {
+  unsigned int i;
+
+  r->signatures += __atomic_load_n(&a->signatures, __ATOMIC_RELAXED);
+  r->iterations += __atomic_load_n(&a->iterations, __ATOMIC_RELAXED);
+  for(i = 0; i < SIGNSTATS_REASONS; ++i)
+    r->rejections[i] += __atomic_load_n(&a->rejections[i], __ATOMIC_RELAXED);
+  for(i = 0; i < SIGNSTATS_MAX_ITERATIONS; ++i)
+    r->histogram[i] += __atomic_load_n(&a->histogram[i], __ATOMIC_RELAXED);
+}
+
+/*************************************************
+* Name:        signstats_clear
+*
+* Description: Clear the counters of a statistics record.
+*
+* Arguments:   - signstats *s: pointer to statistics
+**************************************************/
+static void signstats_clear(signstats *s) {
+  unsigned int i;
+
+  __atomic_store_n(&s->signatures, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&s->iterations, 0, __ATOMIC_RELAXED);
+  for(i = 0; i < SIGNSTATS_REASONS; ++i)
+    __atomic_store_n(&s->rejections[i], 0, __ATOMIC_RELAXED);
+  for(i = 0; i < SIGNSTATS_MAX_ITERATIONS; ++i)
+    __atomic_store_n(&s->histogram[i], 0, __ATOMIC_RELAXED);
+}
+
+/*************************************************
+* Name:        signstats_retire
+*
+* Description: Thread exit handler; folds the statistics of the exiting
+*              thread into the retired total and unlinks its record.
+*
+* Arguments:   - void *arg: pointer to record of exiting thread
+**************************************************/
+static void signstats_retire(void *arg) {
+  signstats_record *rec = arg, **p;
+
+  pthread_mutex_lock(&stats_lock);
+  signstats_add(&stats_retired, &rec->stats);
+  for(p = &stats_list; *p; p = &(*p)->next)
+    if(*p == rec) {
+      *p = rec->next;
+      break;
+    }
+  rec->registered = 0;
+  pthread_mutex_unlock(&stats_lock);
+}
+
+static void signstats_key_init(void) {
+  pthread_key_create(&stats_key, signstats_retire);
+}
+
+/*************************************************
+* Name:        signstats_register
+*
+* Description: Link the record of the calling thread into the global list
+*              unless it already is.
+**************************************************/
+static void signstats_register(void) {
+  if(stats_tls.registered)
+    return;
+
+  pthread_once(&stats_once, signstats_key_init);
+  pthread_mutex_lock(&stats_lock);
+  stats_tls.next = stats_list;
+  stats_list = &stats_tls;
+  stats_tls.registered = 1;
+  pthread_mutex_unlock(&stats_lock);
+  pthread_setspecific(stats_key, &stats_tls);
+}
+
+/*************************************************
+* Name:        signstats_begin
+*
+* Description: Start recording a new signature.
+**************************************************/
+void signstats_begin(void) {
+  signstats_register();
+  memset(stats_tls.stats.last_rejections, 0,
+         sizeof(stats_tls.stats.last_rejections));
+  stats_tls.stats.last_iterations = 0;
+}
+
+/*************************************************
+* Name:        signstats_reject
+*
+* Description: Record rejected iteration of the current signature.
+*
+* Arguments:   - unsigned int reason: check that failed, one of
+*                                     SIGNSTATS_REJECT_*
+**************************************************/
+void signstats_reject(unsigned int reason) {
+  ++stats_tls.stats.last_iterations;
+  ++stats_tls.stats.last_rejections[reason];
+  __atomic_fetch_add(&stats_tls.stats.rejections[reason], 1,
+                     __ATOMIC_RELAXED);
+}
+
+/*************************************************
+* Name:        signstats_accept
+*
+* Description: Record accepted iteration and finish the current signature.
+**************************************************/
+void signstats_accept(void) {
+  unsigned int n;
+
+  n = ++stats_tls.stats.last_iterations;
+  if(n > SIGNSTATS_MAX_ITERATIONS)
+    n = SIGNSTATS_MAX_ITERATIONS;
+
+  __atomic_fetch_add(&stats_tls.stats.histogram[n - 1], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&stats_tls.stats.iterations,
+                     stats_tls.stats.last_iterations, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&stats_tls.stats.signatures, 1, __ATOMIC_RELAXED);
+}
+
+/*************************************************
+* Name:        signstats_get
+*
+* Description: Read signing statistics of the calling thread. The last_*
+*              fields describe the most recent signature.
+*
+* Arguments:   - signstats *stats: pointer to output statistics
+**************************************************/
+void signstats_get(signstats *stats) {
+  *stats = stats_tls.stats;
+}
+
+/*************************************************
+* Name:        signstats_get_all
+*
+* Description: Sum signing statistics of all threads that ever signed,
+*              including threads that have exited. Counters of threads
+*              signing concurrently are read without stopping them. The
+*              last_* fields are zero.
+*
+* Arguments:   - signstats *stats: pointer to output statistics
+**************************************************/
+void signstats_get_all(signstats *stats) {
+  signstats_record *rec;
+
+  memset(stats, 0, sizeof(*stats));
+  pthread_mutex_lock(&stats_lock);
+  signstats_add(stats, &stats_retired);
+  for(rec = stats_list; rec; rec = rec->next)
+    signstats_add(stats, &rec->stats);
+  pthread_mutex_unlock(&stats_lock);
+}
+
+/*************************************************
+* Name:        signstats_reset
+*
+* Description: Clear signing statistics of the calling thread.
+**************************************************/
+void signstats_reset(void) {
+  signstats_clear(&stats_tls.stats);
+  memset(stats_tls.stats.last_rejections, 0,
+         sizeof(stats_tls.stats.last_rejections));
+  stats_tls.stats.last_iterations = 0;
+}
+
+/*************************************************
+* Name:        signstats_reset_all
+*
+* Description: Clear signing statistics of all threads. Signatures in
+*              progress on other threads may be counted partially.
+**************************************************/
+void signstats_reset_all(void) {
+  signstats_record *rec;
+
+  pthread_mutex_lock(&stats_lock);
+  signstats_clear(&stats_retired);
+  for(rec = stats_list; rec; rec = rec->next)
+    signstats_clear(&rec->stats);
+  pthread_mutex_unlock(&stats_lock);
+}
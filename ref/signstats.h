@@ -0,0 +1,43 @@
+#ifndef SIGNSTATS_H
+#define SIGNSTATS_H
+
+#include "config.h"
+
+#define SIGNSTATS_REJECT_W0 0
+#define SIGNSTATS_REJECT_Z 1
+#define SIGNSTATS_REJECT_CT0 2
+#define SIGNSTATS_REJECT_HINT 3
+#define SIGNSTATS_REASONS 4
+
+/* Signatures needing this many or more iterations share the last bucket */
+#define SIGNSTATS_MAX_ITERATIONS 32
+
+typedef struct {
+  unsigned long long signatures;
+  unsigned long long iterations;
+  unsigned long long rejections[SIGNSTATS_REASONS];
+  unsigned long long histogram[SIGNSTATS_MAX_ITERATIONS];
+  unsigned int last_iterations;
+  unsigned int last_rejections[SIGNSTATS_REASONS];
+} signstats;
+
+#ifdef SIGN_STATS
+#define SIGNSTATS_BEGIN() signstats_begin()
+#define SIGNSTATS_REJECT(REASON) signstats_reject(REASON)
+#define SIGNSTATS_ACCEPT() signstats_accept()
+#else
+#define SIGNSTATS_BEGIN()
+#define SIGNSTATS_REJECT(REASON)
+#define SIGNSTATS_ACCEPT()
+#endif
+
+void signstats_begin(void);
+void signstats_reject(unsigned int reason);
+void signstats_accept(void);
+
+void signstats_get(signstats *stats);
+void signstats_get_all(signstats *stats);
+void signstats_reset(void);
+void signstats_reset_all(void);
+
+#endif
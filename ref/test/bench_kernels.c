@@ -0,0 +1,106 @@
+#include <stdint.h>
+#include <stdio.h>
+#include "cpucycles.h"
+#include "speed.h"
+#include "../params.h"
+#include "../randombytes.h"
+#include "../fips202.h"
+#include "../poly.h"
+#include "../polyvec.h"
+#include "../packing.h"
+#include "../sign.h"
+
+#define NTESTS 10000
+
+#define BENCH(name, call)                                               \
+  do {                                                                  \
+    for(i = 0; i < opts.warmup; ++i)                                    \
+      call;                                                             \
+    for(i = 0; i < NTESTS; ++i) {                                       \
+      t[i] = cpucycles_start();                                         \
+      call;                                                             \
+      t[i] = cpucycles_stop() - t[i] - overhead;                        \
+    }                                                                   \
+    print_results(name, t, NTESTS);                                     \
+  } while(0)
+
+static unsigned long long t[NTESTS];
+
+int main(int argc, char **argv) {
+  unsigned int i;
+  unsigned long long overhead, siglen;
+  unsigned char seed[CRHBYTES];
+  unsigned char buf[5*SHAKE128_RATE];
+  unsigned char pk[CRYPTO_PUBLICKEYBYTES];
+  unsigned char sk[CRYPTO_SECRETKEYBYTES];
+  unsigned char sig[CRYPTO_BYTES];
+  unsigned char packed[POLZ_SIZE_PACKED];
+  unsigned char rho[SEEDBYTES], key[SEEDBYTES], tr[CRHBYTES];
+  keccak_state state;
+  speed_options opts;
+  poly a, b, c;
+  poly_prepared bp;
+  polyvecl mat[K], s1, z;
+  polyveck s2, t0, t1, w1, h;
+
+  parse_options(&opts, argc, argv);
+  print_begin(&opts, "ref");
+  overhead = cpucycles_overhead();
+
+  randombytes(seed, sizeof(seed));
+  crypto_sign_keypair(pk, sk);
+  crypto_sign_signature(sig, &siglen, seed, sizeof(seed), sk);
+  unpack_sk(rho, key, tr, &s1, &s2, &t0, sk);
+  unpack_pk(rho, &t1, pk);
+  unpack_sig(&z, &h, &c, sig);
+  polyveck_use_hint(&w1, &t1, &h);
+  expand_mat(mat, rho);
+  poly_uniform(&a, seed, 0);
+  poly_uniform(&b, seed, 1);
+  poly_prepare(&bp, &b);
+  shake128_absorb(&state, seed, SEEDBYTES);
+
+  /* Arithmetic */
+  BENCH("poly_ntt", poly_ntt(&a));
+  BENCH("poly_invntt_montgomery", poly_invntt_montgomery(&a));
+  BENCH("poly_pointwise_invmontgomery",
+        poly_pointwise_invmontgomery(&c, &a, &b));
+  BENCH("poly_pointwise_prepared", poly_pointwise_prepared(&c, &a, &bp));
+  BENCH("polyvecl_pointwise_acc_invmontgomery",
+        polyvecl_pointwise_acc_invmontgomery(&c, &mat[0], &s1));
+  BENCH("polyvecl_pointwise_acc_invntt",
+        polyvecl_pointwise_acc_invntt(&c, &mat[0], &s1));
+  poly_freeze(&a);
+  BENCH("poly_decompose", poly_decompose(&b, &c, &a));
+  BENCH("poly_make_hint", poly_make_hint(&h.vec[0], &c, &b));
+  BENCH("poly_use_hint", poly_use_hint(&w1.vec[0], &a, &h.vec[0]));
+
+  /* Sampling */
+  BENCH("shake128_squeezeblocks",
+        shake128_squeezeblocks(buf, 1, &state));
+  BENCH("poly_uniform", poly_uniform(&a, seed, i));
+  BENCH("poly_uniform_eta", poly_uniform_eta(&a, seed, i));
+  BENCH("poly_uniform_gamma1m1", poly_uniform_gamma1m1(&a, seed, i));
+  BENCH("expand_mat", expand_mat(mat, rho));
+  BENCH("challenge", challenge(&c, seed, &w1));
+
+  /* Packing */
+  BENCH("polyeta_pack", polyeta_pack(packed, &s1.vec[0]));
+  BENCH("polyeta_unpack", polyeta_unpack(&a, packed));
+  BENCH("polyt1_pack", polyt1_pack(packed, &t1.vec[0]));
+  BENCH("polyt1_unpack", polyt1_unpack(&a, packed));
+  BENCH("polyt0_pack", polyt0_pack(packed, &t0.vec[0]));
+  BENCH("polyt0_unpack", polyt0_unpack(&a, packed));
+  BENCH("polyz_pack", polyz_pack(packed, &z.vec[0]));
+  BENCH("polyz_unpack", polyz_unpack(&a, packed));
+  BENCH("polyw1_pack", polyw1_pack(packed, &w1.vec[0]));
+  BENCH("pack_pk", pack_pk(pk, rho, &t1));
+  BENCH("unpack_pk", unpack_pk(rho, &t1, pk));
+  BENCH("pack_sk", pack_sk(sk, rho, key, tr, &s1, &s2, &t0));
+  BENCH("unpack_sk", unpack_sk(rho, key, tr, &s1, &s2, &t0, sk));
+  BENCH("pack_sig", pack_sig(sig, &z, &h, &c));
+  BENCH("unpack_sig", unpack_sig(&z, &h, &c, sig));
+
+  print_end();
+  return 0;
+}
@@ -0,0 +1,326 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "speed.h"
+#include "../api.h"
+#include "../randombytes.h"
+
+/*
+ * Throughput benchmark: runs an operation on 1, 2, 4, ... threads for a fixed
+ * duration each and reports operations per second. The threads cycle through
+ * a set of keys generated up front; with a single key all threads share it.
+ * Random bytes come from the kernel or from the per-thread DRBG (-r).
+ * The benchmark starts its own threads, so the thread count is not limited
+ * by the size of the library's thread pool.
+ */
+
+#define OP_KEYGEN 0
+#define OP_SIGN 1
+#define OP_VERIFY 2
+#define OP_MIXED 3
+
+static const char *op_names[4] = {"keygen", "sign", "verify", "mixed"};
+static const char *rng_names[2] = {"system", "drbg"};
+static const randombytes_fn rng_sources[2] = {randombytes_system,
+                                              randombytes_drbg};
+
+struct bench_ctx;
+
+typedef struct {
+  unsigned long long ops;
+  int failed;
+  unsigned int t;
+  struct bench_ctx *ctx;
+  pthread_t thread;
+} __attribute__((aligned(64))) bench_counter;
+
+typedef struct bench_ctx {
+  int op;
+  unsigned int nkeys;
+  size_t mlen;
+  unsigned char *pk;
+  unsigned char *sk;
+  unsigned char *m;
+  unsigned char *sm;
+  unsigned long long *smlen;
+  struct timespec deadline;
+  bench_counter *counters;
+} bench_ctx;
+
+static int expired(const struct timespec *deadline) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec > deadline->tv_sec
+         || (now.tv_sec == deadline->tv_sec
+             && now.tv_nsec >= deadline->tv_nsec);
+}
+
+/*************************************************
+* Name:        bench_thread
+*
+* Description: Run operations of benchmark in thread t until the deadline.
+*              Thread t starts with key t and then cycles through all keys.
+*
+* Arguments:   - void *arg: pointer to benchmark context
+*              - unsigned int t: thread index
+**************************************************/
+static void bench_thread(void *arg, unsigned int t) {
+  int op;
+  unsigned int k;
+  unsigned long long i, len;
+  unsigned char pk[CRYPTO_PUBLICKEYBYTES];
+  unsigned char sk[CRYPTO_SECRETKEYBYTES];
+  unsigned char *buf;
+  bench_ctx *ctx = arg;
+  bench_counter *c = &ctx->counters[t];
+  const size_t smsize = ctx->mlen + CRYPTO_BYTES;
+
+  c->ops = 0;
+  c->failed = 0;
+  buf = malloc(smsize);
+  if(!buf) {
+    c->failed = 1;
+    return;
+  }
+
+  k = t % ctx->nkeys;
+  for(i = 0; !expired(&ctx->deadline); ++i) {
+    op = (ctx->op == OP_MIXED) ? (int)(i % 3) : ctx->op;
+    switch(op) {
+      case OP_KEYGEN:
+        crypto_sign_keypair(pk, sk);
+        break;
+      case OP_SIGN:
+        crypto_sign(buf, &len, ctx->m, ctx->mlen,
+                    ctx->sk + k*CRYPTO_SECRETKEYBYTES);
+        break;
+      case OP_VERIFY:
+        if(crypto_sign_open(buf, &len, ctx->sm + k*smsize, ctx->smlen[k],
+                            ctx->pk + k*CRYPTO_PUBLICKEYBYTES))
+          c->failed = 1;
+        break;
+    }
+    ++c->ops;
+    if(op != OP_KEYGEN)
+      k = (k + 1) % ctx->nkeys;
+  }
+
+  free(buf);
+}
+
+static void *bench_start(void *arg) {
+  bench_counter *c = arg;
+
+  bench_thread(c->ctx, c->t);
+  return NULL;
+}
+
+/*************************************************
+* Name:        bench_run
+*
+* Description: Run benchmark on nthreads threads for the given duration;
+*              the calling thread is one of them. ctx->counters must hold
+*              nthreads entries.
+*
+* Arguments:   - bench_ctx *ctx: pointer to benchmark context
+*              - unsigned int nthreads: number of threads
+*              - double duration: duration in seconds
+*              - unsigned long long *ops: pointer to output number of
+*                                         operations
+*              - double *secs: pointer to output elapsed time in seconds
+*
+* Returns 0 on success and -1 on failure
+**************************************************/
+static int bench_run(bench_ctx *ctx, unsigned int nthreads, double duration,
+                     unsigned long long *ops, double *secs)
+{
+  unsigned int i, n;
+  int ret = 0;
+  long long ns;
+  struct timespec start, stop;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  ns = start.tv_nsec + (long long)(duration*1e9);
+  ctx->deadline.tv_sec = start.tv_sec + ns/1000000000;
+  ctx->deadline.tv_nsec = ns%1000000000;
+
+  for(n = 1; n < nthreads; ++n) {
+    ctx->counters[n].t = n;
+    ctx->counters[n].ctx = ctx;
+    if(pthread_create(&ctx->counters[n].thread, NULL, bench_start,
+                      &ctx->counters[n]))
+      break;
+  }
+
+  bench_thread(ctx, 0);
+  for(i = 1; i < n; ++i)
+    pthread_join(ctx->counters[i].thread, NULL);
+
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  if(n < nthreads)
+    return -1;
+
+  *ops = 0;
+  for(i = 0; i < nthreads; ++i) {
+    if(ctx->counters[i].failed)
+      ret = -1;
+    *ops += ctx->counters[i].ops;
+  }
+  if(ret)
+    return -1;
+  *secs = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec)*1e-9;
+  return 0;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr, "usage: %s [-o keygen|sign|verify|mixed] [-t threads] "
+          "[-d seconds] [-k keys] [-m mlen] [-r system|drbg] "
+          "[-f text|csv|json]\n"
+          "  -t: maximum number of threads, default is the number of "
+          "online CPUs\n", prog);
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  int c, rng = 0, format = FORMAT_TEXT;
+  unsigned int i, n, maxthreads;
+  unsigned long long ops;
+  double duration = 2, secs, base = 0;
+  long ncpus;
+  bench_ctx *ctx;
+
+  ctx = malloc(sizeof(bench_ctx));
+  if(!ctx)
+    return -1;
+  ctx->op = OP_SIGN;
+  ctx->nkeys = 1;
+  ctx->mlen = 59;
+  ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+  maxthreads = ncpus > 0 ? ncpus : 1;
+
+  while((c = getopt(argc, argv, "o:t:d:k:m:r:f:")) != -1) {
+    switch(c) {
+      case 'o':
+        for(i = 0; i < 4; ++i)
+          if(!strcmp(optarg, op_names[i]))
+            break;
+        if(i == 4)
+          usage(argv[0]);
+        ctx->op = i;
+        break;
+      case 't':
+        if(atoi(optarg) <= 0)
+          usage(argv[0]);
+        maxthreads = atoi(optarg);
+        break;
+      case 'd':
+        duration = atof(optarg);
+        break;
+      case 'k':
+        ctx->nkeys = atoi(optarg);
+        break;
+      case 'm':
+        ctx->mlen = atol(optarg);
+        break;
+      case 'r':
+        for(i = 0; i < 2; ++i)
+          if(!strcmp(optarg, rng_names[i]))
+            break;
+        if(i == 2)
+          usage(argv[0]);
+        rng = i;
+        break;
+      case 'f':
+        if(!strcmp(optarg, "text"))
+          format = FORMAT_TEXT;
+        else if(!strcmp(optarg, "csv"))
+          format = FORMAT_CSV;
+        else if(!strcmp(optarg, "json"))
+          format = FORMAT_JSON;
+        else
+          usage(argv[0]);
+        break;
+      default:
+        usage(argv[0]);
+    }
+  }
+
+  if(!maxthreads || !ctx->nkeys || duration <= 0)
+    usage(argv[0]);
+
+  randombytes_set_source(rng_sources[rng]);
+
+  ctx->pk = malloc((size_t)ctx->nkeys*CRYPTO_PUBLICKEYBYTES);
+  ctx->sk = malloc((size_t)ctx->nkeys*CRYPTO_SECRETKEYBYTES);
+  ctx->sm = malloc((size_t)ctx->nkeys*(ctx->mlen + CRYPTO_BYTES));
+  ctx->smlen = malloc((size_t)ctx->nkeys*sizeof(unsigned long long));
+  ctx->m = malloc(ctx->mlen + 1);
+  ctx->counters = aligned_alloc(64, (size_t)maxthreads*sizeof(bench_counter));
+  if(!ctx->pk || !ctx->sk || !ctx->sm || !ctx->smlen || !ctx->m
+     || !ctx->counters) {
+    printf("Allocation failed\n");
+    return -1;
+  }
+
+  randombytes(ctx->m, ctx->mlen);
+  for(i = 0; i < ctx->nkeys; ++i) {
+    crypto_sign_keypair(ctx->pk + i*CRYPTO_PUBLICKEYBYTES,
+                        ctx->sk + i*CRYPTO_SECRETKEYBYTES);
+    crypto_sign(ctx->sm + i*(ctx->mlen + CRYPTO_BYTES), &ctx->smlen[i],
+                ctx->m, ctx->mlen, ctx->sk + i*CRYPTO_SECRETKEYBYTES);
+  }
+
+  if(format == FORMAT_TEXT)
+    printf("%s %s, %u key(s), %zu byte messages, %s rng, %.3g s per run\n"
+           "threads        ops/sec     per thread   speedup\n",
+           CRYPTO_ALGNAME, op_names[ctx->op], ctx->nkeys, ctx->mlen,
+           rng_names[rng], duration);
+  else if(format == FORMAT_CSV)
+    printf("algorithm,operation,keys,mlen,rng,threads,ops,seconds,"
+           "ops_per_sec\n");
+  else
+    printf("{\n  \"algorithm\": \"%s\",\n  \"operation\": \"%s\",\n"
+           "  \"keys\": %u,\n  \"mlen\": %zu,\n  \"rng\": \"%s\",\n"
+           "  \"results\": [",
+           CRYPTO_ALGNAME, op_names[ctx->op], ctx->nkeys, ctx->mlen,
+           rng_names[rng]);
+
+  for(n = 1; n <= maxthreads; n = (n < maxthreads && 2*n > maxthreads)
+                                  ? maxthreads : 2*n) {
+    if(bench_run(ctx, n, duration, &ops, &secs)) {
+      printf("Benchmark on %u threads failed\n", n);
+      return -1;
+    }
+    if(n == 1)
+      base = ops/secs;
+
+    if(format == FORMAT_TEXT)
+      printf("%7u %14.1f %14.1f %9.2f\n", n, ops/secs, ops/secs/n,
+             ops/secs/base);
+    else if(format == FORMAT_CSV)
+      printf("%s,%s,%u,%zu,%s,%u,%llu,%.6f,%.1f\n", CRYPTO_ALGNAME,
+             op_names[ctx->op], ctx->nkeys, ctx->mlen, rng_names[rng], n,
+             ops, secs, ops/secs);
+    else
+      printf("%s\n    {\"threads\": %u, \"ops\": %llu, \"seconds\": %.6f, "
+             "\"ops_per_sec\": %.1f}", n > 1 ? "," : "", n, ops, secs,
+             ops/secs);
+  }
+
+  if(format == FORMAT_JSON)
+    printf("\n  ]\n}\n");
+
+  free(ctx->pk);
+  free(ctx->sk);
+  free(ctx->sm);
+  free(ctx->smlen);
+  free(ctx->m);
+  free(ctx->counters);
+  free(ctx);
+  return 0;
+}
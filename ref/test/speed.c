@@ -1,7 +1,28 @@
+#define _GNU_SOURCE
+#include <sched.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "cpucycles.h"
 #include "speed.h"
 #include "../config.h"
+#include "../api.h"
+
+#ifdef USE_RDPMC
+#define UNIT "cycles"
+#else
+#define UNIT "ticks"
+#endif
+
+/* Log-linear histogram buckets with 2^HIST_SUBBITS buckets per power of 2 */
+#define HIST_SUBBITS 3
+
+static int format = FORMAT_TEXT;
+static int histogram;
+static unsigned int nresults;
+static double ghz;
 
 static int cmp_llu(const void *a, const void *b) {
   if(*(unsigned long long *)a < *(unsigned long long *)b) return -1;
@@ -26,24 +47,220 @@ static unsigned long long average(unsigned long long *t, size_t tlen) {
   return acc/(tlen);
 }
 
+/* Percentile of sorted array by nearest rank, p in per mille */
+static unsigned long long percentile(unsigned long long *l, size_t llen,
+                                     unsigned int p)
+{
+  size_t i = (llen*p + 999)/1000;
+
+  return l[i ? i - 1 : 0];
+}
+
+/* Lower bound of histogram bucket containing t */
+static unsigned long long bucket(unsigned long long t) {
+  unsigned int e = 0;
+
+  while(t >> (e + HIST_SUBBITS + 1))
+    ++e;
+
+  return (t >> e) << e;
+}
+
+/*************************************************
+* Name:        tsc_ghz
+*
+* Description: Measure frequency of the cycle counter against the monotonic
+*              clock. The measurement takes 100 ms and is done once.
+*
+* Returns frequency in GHz
+**************************************************/
+double tsc_ghz(void) {
+  unsigned long long t0, t1, ns;
+  struct timespec start, now;
+
+  if(ghz)
+    return ghz;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  t0 = cpucycles_start();
+  do {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ns = (now.tv_sec - start.tv_sec)*1000000000ULL
+         + now.tv_nsec - start.tv_nsec;
+  } while(ns < 100000000);
+  t1 = cpucycles_stop();
+
+  ghz = (double)(t1 - t0)/ns;
+  return ghz;
+}
+
+/*************************************************
+* Name:        parse_options
+*
+* Description: Parse command line of benchmark programs. Supported options
+*              are -f text|csv|json (output format), -H (print latency
+*              histograms), -c cpu (pin to cpu) and -w n (number of warmup
+*              iterations). Exits on invalid options.
+*
+* Arguments:   - speed_options *opts: pointer to output options
+*              - int argc: number of arguments
+*              - char **argv: array of arguments
+**************************************************/
+void parse_options(speed_options *opts, int argc, char **argv) {
+  int c;
+  cpu_set_t set;
+
+  opts->format = FORMAT_TEXT;
+  opts->histogram = 0;
+  opts->cpu = -1;
+  opts->warmup = 0;
+
+  while((c = getopt(argc, argv, "f:Hc:w:")) != -1) {
+    switch(c) {
+      case 'f':
+        if(!strcmp(optarg, "text"))
+          opts->format = FORMAT_TEXT;
+        else if(!strcmp(optarg, "csv"))
+          opts->format = FORMAT_CSV;
+        else if(!strcmp(optarg, "json"))
+          opts->format = FORMAT_JSON;
+        else
+          goto usage;
+        break;
+      case 'H':
+        opts->histogram = 1;
+        break;
+      case 'c':
+        opts->cpu = atoi(optarg);
+        break;
+      case 'w':
+        opts->warmup = atoi(optarg);
+        break;
+      default:
+        goto usage;
+    }
+  }
+
+  if(opts->cpu >= 0) {
+    CPU_ZERO(&set);
+    CPU_SET(opts->cpu, &set);
+    if(sched_setaffinity(0, sizeof(set), &set)) {
+      fprintf(stderr, "Pinning to cpu %d failed\n", opts->cpu);
+      exit(1);
+    }
+  }
+
+  return;
+
+  usage:
+  fprintf(stderr, "usage: %s [-f text|csv|json] [-H] [-c cpu] [-w warmup]\n",
+          argv[0]);
+  exit(1);
+}
+
+/*************************************************
+* Name:        print_begin
+*
+* Description: Start output of results in the given format. Programs not
+*              calling print_begin print text.
+*
+* Arguments:   - const speed_options *opts: pointer to options
+*              - const char *impl: name of implementation, may be NULL
+**************************************************/
+void print_begin(const speed_options *opts, const char *impl) {
+  format = opts->format;
+  histogram = opts->histogram;
+  nresults = 0;
+
+  if(format == FORMAT_CSV)
+    printf("algorithm,name,median,average,p90,p99,p999,max,unit,ghz\n");
+  else if(format == FORMAT_JSON) {
+    printf("{\n");
+    if(impl)
+      printf("  \"implementation\": \"%s\",\n", impl);
+    printf("  \"algorithm\": \"%s\",\n  \"unit\": \"%s\",\n"
+           "  \"ghz\": %.4f,\n  \"results\": [", CRYPTO_ALGNAME, UNIT,
+           tsc_ghz());
+  }
+}
+
+/*************************************************
+* Name:        print_results
+*
+* Description: Print median, average, percentiles and maximum of timings
+*              and, if requested, a log-linear latency histogram. Sorts t.
+*
+* Arguments:   - const char *s: name of measured operation, without colon
+*              - unsigned long long *t: array of timings
+*              - size_t tlen: number of timings
+**************************************************/
 void print_results(const char *s, unsigned long long *t, size_t tlen) {
-  unsigned long long tmp;
+  static const unsigned int pm[5] = {500, 900, 990, 999, 1000};
+  static const char *pname[5] = {"median", "p90", "p99", "p99.9", "max"};
+  unsigned long long med, avg, b;
+  size_t i, j;
 
-  printf("%s\n", s);
+  med = median(t, tlen);
+  avg = average(t, tlen);
 
-  tmp = median(t, tlen);
-#ifdef USE_RDPMC
-  printf("median: %llu cycles\n", tmp);
-#else
-  printf("median: %llu ticks @ 2.6 GHz (%.4g msecs)\n", tmp, MSECS(tmp));
-#endif
+  if(format == FORMAT_CSV) {
+    printf("%s,%s,%llu,%llu", CRYPTO_ALGNAME, s, med, avg);
+    for(i = 1; i < 5; ++i)
+      printf(",%llu", percentile(t, tlen, pm[i]));
+    printf(",%s,%.4f\n", UNIT, tsc_ghz());
+    return;
+  }
 
-  tmp = average(t, tlen);
-#ifdef USE_RDPMC
-  printf("average: %llu cycles\n", tmp);
-#else
-  printf("average: %llu ticks @ 2.6 GHz (%.4g msecs)\n", tmp, MSECS(tmp));
-#endif
+  if(format == FORMAT_JSON) {
+    printf("%s\n    {\"name\": \"%s\", \"median\": %llu, \"average\": %llu",
+           nresults++ ? "," : "", s, med, avg);
+    printf(", \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu",
+           percentile(t, tlen, 900), percentile(t, tlen, 990),
+           percentile(t, tlen, 999), t[tlen - 1]);
+    if(histogram) {
+      printf(", \"histogram\": [");
+      for(i = 0; i < tlen; i = j) {
+        b = bucket(t[i]);
+        for(j = i; j < tlen && bucket(t[j]) == b; ++j)
+          ;
+        printf("%s[%llu, %zu]", i ? ", " : "", b, j - i);
+      }
+      printf("]");
+    }
+    printf("}");
+    return;
+  }
+
+  printf("%s:\n", s);
+  printf("median: %llu %s @ %.2f GHz (%.4g msecs)\n", med, UNIT, tsc_ghz(),
+         med/(tsc_ghz()*1e6));
+  printf("average: %llu %s @ %.2f GHz (%.4g msecs)\n", avg, UNIT, tsc_ghz(),
+         avg/(tsc_ghz()*1e6));
+  for(i = 1; i < 5; ++i) {
+    b = percentile(t, tlen, pm[i]);
+    printf("%s: %llu %s (%.4g msecs)\n", pname[i], b, UNIT,
+           b/(tsc_ghz()*1e6));
+  }
+
+  if(histogram) {
+    for(i = 0; i < tlen; i = j) {
+      b = bucket(t[i]);
+      for(j = i; j < tlen && bucket(t[j]) == b; ++j)
+        ;
+      printf("  >= %10llu: %6zu (%6.2f%%, cumulative %6.2f%%)\n", b, j - i,
+             100.0*(j - i)/tlen, 100.0*j/tlen);
+    }
+  }
 
   printf("\n");
 }
+
+/*************************************************
+* Name:        print_end
+*
+* Description: Finish output of results.
+**************************************************/
+void print_end(void) {
+  if(format == FORMAT_JSON)
+    printf("\n  ]\n}\n");
+}
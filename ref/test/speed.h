@@ -1,8 +1,24 @@
-#ifndef SPEED_H
-#define SPEED_H
-
-#define MSECS(t) ((double)(t)/(2600000))
-
-void print_results(const char *s, unsigned long long *t, size_t tlen);
-
-#endif
+#ifndef SPEED_H
+#define SPEED_H
+
+#include <stddef.h>
+
+#define FORMAT_TEXT 0
+#define FORMAT_CSV 1
+#define FORMAT_JSON 2
+
+typedef struct {
+  int format;
+  int histogram;
+  int cpu;
+  unsigned int warmup;
+} speed_options;
+
+void parse_options(speed_options *opts, int argc, char **argv);
+double tsc_ghz(void);
+
+void print_begin(const speed_options *opts, const char *impl);
+void print_results(const char *s, unsigned long long *t, size_t tlen);
+void print_end(void);
+
+#endif
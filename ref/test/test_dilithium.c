@@ -1,20 +1,28 @@
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
 #include "cpucycles.h"
 #include "speed.h"
 #include "../randombytes.h"
 #include "../params.h"
 #include "../sign.h"
+#include "../matcache.h"
+#include "../signbatch.h"
+#include "../signstats.h"
 
 #define MLEN 59
 #define NTESTS 1000
+#define NBATCH 7
+#define NTHREADS 3
+#define NPARALLEL 100
 
 unsigned long long timing_overhead;
 #ifdef DBENCH
 unsigned long long *tred, *tadd, *tmul, *tround, *tsample, *tpack, *tshake;
 #endif
 
-int main(void)
+int main(int argc, char **argv)
 {
   unsigned int i;
   int ret;
@@ -25,6 +33,36 @@ int main(void)
   unsigned char pk[CRYPTO_PUBLICKEYBYTES];
   unsigned char sk[CRYPTO_SECRETKEYBYTES];
   unsigned long long tkeygen[NTESTS], tsign[NTESTS], tverify[NTESTS];
+  unsigned long long tsignexp[NTESTS], tverifyexp[NTESTS];
+  unsigned long long tsignlow[NTESTS], tverifylow[NTESTS];
+  expanded_sk esk;
+  expanded_pk epk;
+  unsigned char bpk[NBATCH][CRYPTO_PUBLICKEYBYTES];
+  unsigned char bsm[NBATCH][MLEN + CRYPTO_BYTES];
+  unsigned char bm[NBATCH][MLEN + CRYPTO_BYTES];
+  const unsigned char *bpkp[NBATCH], *bsmp[NBATCH];
+  unsigned char *bmp[NBATCH];
+  unsigned long long bsmlen[NBATCH], bmlen[NBATCH];
+  unsigned long long tbatch[NTESTS/NBATCH];
+  unsigned long long tsignpar[NPARALLEL];
+  unsigned long long tsignbatch[NTESTS/NBATCH];
+  unsigned char bsk[2][CRYPTO_SECRETKEYBYTES];
+  unsigned char bsm2[NBATCH][MLEN + CRYPTO_BYTES];
+  const unsigned char *bmcp[NBATCH], *bskp[NBATCH];
+  unsigned char *bsm2p[NBATCH];
+  unsigned long long bsmlen2[NBATCH];
+  sign_batch_stats bstats;
+  speed_options opts;
+#ifdef SIGN_STATS
+  signstats sstats;
+  unsigned long long nsigned;
+#endif
+  int bres[NBATCH], fds[2];
+  pid_t pid;
+  matcache_stats mcstats;
+  threadpool pool;
+  sign_state st;
+  unsigned char sig[CRYPTO_BYTES];
 #ifdef DBENCH
   unsigned long long t[7][NTESTS], dummy;
 
@@ -32,8 +70,16 @@ int main(void)
   tred = tadd = tmul = tround = tsample = tpack = tshake = &dummy;
 #endif
 
+  parse_options(&opts, argc, argv);
   timing_overhead = cpucycles_overhead();
 
+  for(i = 0; i < opts.warmup; ++i) {
+    randombytes(m, MLEN);
+    crypto_sign_keypair(pk, sk);
+    crypto_sign(sm, &smlen, m, MLEN, sk);
+    crypto_sign_open(m2, &mlen, sm, smlen, pk);
+  }
+
   for(i = 0; i < NTESTS; ++i) {
     randombytes(m, MLEN);
 
@@ -59,6 +105,34 @@ int main(void)
     tred = tadd = tmul = tround = tsample = tpack = tshake = &dummy;
 #endif
 
+    crypto_sign_sk_expand(&esk, sk);
+    tsignexp[i] = cpucycles_start();
+    crypto_sign_expanded(m2, &mlen, m, MLEN, &esk);
+    tsignexp[i] = cpucycles_stop() - tsignexp[i] - timing_overhead;
+
+#ifndef RANDOMIZED_SIGNING
+    if(mlen != smlen || memcmp(m2, sm, smlen)) {
+      printf("Signatures with expanded key don't match\n");
+      return -1;
+    }
+#endif
+
+    tsignlow[i] = cpucycles_start();
+    crypto_sign_lowmem(m2, &mlen, m, MLEN, sk);
+    tsignlow[i] = cpucycles_stop() - tsignlow[i] - timing_overhead;
+
+#ifndef RANDOMIZED_SIGNING
+    if(mlen != smlen || memcmp(m2, sm, smlen)) {
+      printf("Low-memory signatures don't match\n");
+      return -1;
+    }
+#else
+    if(crypto_sign_open(m2, &mlen, m2, mlen, pk)) {
+      printf("Verification of low-memory signature failed\n");
+      return -1;
+    }
+#endif
+
     tverify[i] = cpucycles_start();
     ret = crypto_sign_open(m2, &mlen, sm, smlen, pk);
     tverify[i] = cpucycles_stop() - tverify[i] - timing_overhead;
@@ -80,6 +154,72 @@ int main(void)
       }
     }
 
+    crypto_sign_pk_expand(&epk, pk);
+    tverifyexp[i] = cpucycles_start();
+    ret = crypto_sign_open_expanded(m2, &mlen, sm, smlen, &epk);
+    tverifyexp[i] = cpucycles_stop() - tverifyexp[i] - timing_overhead;
+
+    if(ret || mlen != MLEN) {
+      printf("Verification with expanded key failed\n");
+      return -1;
+    }
+
+    tverifylow[i] = cpucycles_start();
+    ret = crypto_sign_open_lowmem(m2, &mlen, sm, smlen, pk);
+    tverifylow[i] = cpucycles_stop() - tverifylow[i] - timing_overhead;
+
+    if(ret || mlen != MLEN || memcmp(m, m2, MLEN)) {
+      printf("Low-memory verification failed\n");
+      return -1;
+    }
+
+    crypto_sign_signature(sig, &mlen, m, MLEN, sk);
+#ifndef RANDOMIZED_SIGNING
+    if(mlen != CRYPTO_BYTES || memcmp(sig, sm, CRYPTO_BYTES)) {
+      printf("Detached signature doesn't match\n");
+      return -1;
+    }
+#endif
+    crypto_sign_signature_lowmem(sig, &mlen, m, MLEN, sk);
+#ifndef RANDOMIZED_SIGNING
+    if(mlen != CRYPTO_BYTES || memcmp(sig, sm, CRYPTO_BYTES)) {
+      printf("Detached low-memory signature doesn't match\n");
+      return -1;
+    }
+#endif
+    if(crypto_sign_verify(sig, mlen, m, MLEN, pk)
+       || crypto_sign_verify_lowmem(sig, mlen, m, MLEN, pk)) {
+      printf("Detached verification failed\n");
+      return -1;
+    }
+
+    /* Stream message in two pieces split at a varying position */
+    j = i % (MLEN + 1);
+    crypto_sign_init(&st, sk);
+    crypto_sign_update(&st, m, j);
+    crypto_sign_update(&st, m + j, MLEN - j);
+    crypto_sign_final(sig, &mlen, &st, sk);
+#ifndef RANDOMIZED_SIGNING
+    if(mlen != CRYPTO_BYTES || memcmp(sig, sm, CRYPTO_BYTES)) {
+      printf("Incremental signature doesn't match\n");
+      return -1;
+    }
+#endif
+
+    crypto_sign_verify_init(&st, pk);
+    crypto_sign_verify_update(&st, m, j);
+    crypto_sign_verify_update(&st, m + j, MLEN - j);
+    if(crypto_sign_verify_final(&st, sig, mlen, pk)) {
+      printf("Incremental verification failed\n");
+      return -1;
+    }
+
+    ret = crypto_sign_open(m2, &mlen, sm, CRYPTO_BYTES - 1, pk);
+    if(!ret || mlen != (unsigned long long) -1) {
+      printf("Truncated signed message accepted\n");
+      return -1;
+    }
+
     randombytes((unsigned char *) &j, sizeof(j));
     randombytes(m2, 1);
     sm[j % CRYPTO_BYTES] += 1 + (m2[0] % 255);
@@ -88,21 +228,235 @@ int main(void)
       printf("Trivial forgeries possible\n");
       return -1;
     }
+    ret = crypto_sign_open_expanded(m2, &mlen, sm, smlen, &epk);
+    if(!ret) {
+      printf("Trivial forgeries possible with expanded key\n");
+      return -1;
+    }
+    ret = crypto_sign_verify(sm, CRYPTO_BYTES, m, MLEN, pk);
+    if(!ret) {
+      printf("Trivial forgeries possible with detached signature\n");
+      return -1;
+    }
+    ret = crypto_sign_open_lowmem(m2, &mlen, sm, smlen, pk);
+    if(!ret) {
+      printf("Trivial forgeries possible with low-memory verification\n");
+      return -1;
+    }
   }
 
-  print_results("keygen:", tkeygen, NTESTS);
-  print_results("sign: ", tsign, NTESTS);
-  print_results("verify: ", tverify, NTESTS);
+  for(i = 0; i < NBATCH; ++i) {
+    randombytes(m, MLEN);
+    crypto_sign_keypair(bpk[i], sk);
+    crypto_sign(bsm[i], &bsmlen[i], m, MLEN - i, sk);
+    bpkp[i] = bpk[i];
+    bsmp[i] = bsm[i];
+    bmp[i] = bm[i];
+  }
+
+  for(i = 0; i < NTESTS/NBATCH; ++i) {
+    tbatch[i] = cpucycles_start();
+    ret = crypto_sign_open_batch(NBATCH, bpkp, bsmp, bsmlen, bmp, bmlen, bres);
+    tbatch[i] = cpucycles_stop() - tbatch[i] - timing_overhead;
+    tbatch[i] /= NBATCH;
+
+    if(ret) {
+      printf("Batch verification failed\n");
+      return -1;
+    }
+  }
+
+  for(i = 0; i < NBATCH; ++i) {
+    if(bres[i] || bmlen[i] != MLEN - i) {
+      printf("Batch verification results don't match\n");
+      return -1;
+    }
+  }
+
+  bsm[3][0] ^= 1;
+  ret = crypto_sign_open_batch(NBATCH, bpkp, bsmp, bsmlen, bmp, bmlen, bres);
+  for(i = 0; i < NBATCH; ++i) {
+    if(!ret || !bres[i] != (i != 3)) {
+      printf("Trivial forgeries possible in batch verification\n");
+      return -1;
+    }
+  }
+
+  if(matcache_init(1 << 20)) {
+    printf("Matrix cache allocation failed\n");
+    return -1;
+  }
+
+  for(i = 0; i < 2; ++i) {
+    ret = crypto_sign_open(bm[0], &mlen, bsm[0], bsmlen[0], bpk[0]);
+    if(ret || mlen != MLEN) {
+      printf("Verification with matrix cache failed\n");
+      return -1;
+    }
+  }
+
+  matcache_get_stats(&mcstats);
+  matcache_free();
+  if(mcstats.hits != 1 || mcstats.misses != 1 || mcstats.entries != 1) {
+    printf("Matrix cache counters don't match\n");
+    return -1;
+  }
+
+  randombytes_set_source(randombytes_drbg);
+  randombytes(bm[0], MLEN);
+  if(pipe(fds) || (pid = fork()) < 0) {
+    printf("Fork failed\n");
+    return -1;
+  }
+  if(!pid) {
+    randombytes(bm[1], MLEN);
+    _exit(write(fds[1], bm[1], MLEN) != MLEN);
+  }
+  ret = waitpid(pid, NULL, 0) != pid || read(fds[0], bm[1], MLEN) != MLEN;
+  close(fds[0]);
+  close(fds[1]);
+  randombytes(bm[2], MLEN);
+  if(ret || !memcmp(bm[0], bm[2], MLEN) || !memcmp(bm[1], bm[2], MLEN)) {
+    printf("DRBG output repeats\n");
+    return -1;
+  }
+
+  crypto_sign_keypair(pk, sk);
+  crypto_sign(sm, &smlen, bm[0], MLEN, sk);
+  ret = crypto_sign_open(m2, &mlen, sm, smlen, pk);
+  randombytes_set_source(NULL);
+  if(ret || mlen != MLEN) {
+    printf("Verification with DRBG keys failed\n");
+    return -1;
+  }
+
+  if(threadpool_init(&pool, NTHREADS)) {
+    printf("Thread pool creation failed\n");
+    return -1;
+  }
+
+  for(i = 0; i < NPARALLEL; ++i) {
+    randombytes(m, MLEN);
+    crypto_sign_keypair_parallel(pk, sk, &pool);
+    crypto_sign(sm, &smlen, m, MLEN, sk);
+
+    tsignpar[i] = cpucycles_start();
+    crypto_sign_parallel(m2, &mlen, m, MLEN, sk, &pool);
+    tsignpar[i] = cpucycles_stop() - tsignpar[i] - timing_overhead;
+
+#ifndef RANDOMIZED_SIGNING
+    if(mlen != smlen || memcmp(m2, sm, smlen)) {
+      printf("Signatures with thread pool don't match\n");
+      return -1;
+    }
+#endif
+
+    ret = crypto_sign_open(m2, &mlen, m2, mlen, pk);
+    if(ret || mlen != MLEN) {
+      printf("Verification with thread pool keys failed\n");
+      return -1;
+    }
+  }
+
+  crypto_sign_keypair(bpk[0], bsk[0]);
+  crypto_sign_keypair(bpk[1], bsk[1]);
+  for(i = 0; i < NBATCH; ++i) {
+    randombytes(bm[i], MLEN);
+    bmlen[i] = MLEN - i;
+    bmcp[i] = bm[i];
+    bskp[i] = bsk[i % 2];
+    bsm2p[i] = bsm2[i];
+    crypto_sign(bsm[i], &bsmlen[i], bm[i], bmlen[i], bskp[i]);
+  }
+
+#ifdef SIGN_STATS
+  signstats_get_all(&sstats);
+  nsigned = sstats.signatures;
+#endif
+  for(i = 0; i < NTESTS/NBATCH; ++i) {
+    tsignbatch[i] = cpucycles_start();
+    ret = crypto_sign_batch(NBATCH, bsm2p, bsmlen2, bmcp, bmlen, bskp, &pool,
+                            &bstats);
+    tsignbatch[i] = cpucycles_stop() - tsignbatch[i] - timing_overhead;
+    tsignbatch[i] /= NBATCH;
+
+    if(ret || bstats.signatures != NBATCH) {
+      printf("Batch signing failed\n");
+      return -1;
+    }
+  }
+
+#ifdef SIGN_STATS
+  signstats_get_all(&sstats);
+  if(sstats.signatures - nsigned != (NTESTS/NBATCH)*NBATCH) {
+    printf("Batch signing statistics missing\n");
+    return -1;
+  }
+#endif
+
+  for(i = 0; i < NBATCH; ++i) {
+    if(bsmlen2[i] != bsmlen[i]
+#ifndef RANDOMIZED_SIGNING
+       || memcmp(bsm2[i], bsm[i], bsmlen[i])
+#endif
+      ) {
+      printf("Batch signatures don't match\n");
+      return -1;
+    }
+  }
+
+  threadpool_free(&pool);
+
+  print_begin(&opts, NULL);
+  print_results("keygen", tkeygen, NTESTS);
+  print_results("sign", tsign, NTESTS);
+  print_results("sign (expanded key)", tsignexp, NTESTS);
+  print_results("sign (low memory)", tsignlow, NTESTS);
+  print_results("sign (thread pool)", tsignpar, NPARALLEL);
+  print_results("batch sign (per signature)", tsignbatch, NTESTS/NBATCH);
+  print_results("verify", tverify, NTESTS);
+  print_results("verify (expanded key)", tverifyexp, NTESTS);
+  print_results("verify (low memory)", tverifylow, NTESTS);
+  print_results("batch verify (per signature)", tbatch, NTESTS/NBATCH);
+
+#ifdef SIGN_STATS
+  signstats_get_all(&sstats);
+  for(j = 0, i = 0; i < SIGNSTATS_REASONS; ++i)
+    j += sstats.rejections[i];
+  if(sstats.iterations != sstats.signatures + j) {
+    printf("Signing statistics don't add up\n");
+    return -1;
+  }
+
+  if(opts.format == FORMAT_TEXT) {
+    printf("signing iterations (all threads):\n");
+    printf("signatures: %llu, iterations: %llu (%.3f per signature)\n",
+           sstats.signatures, sstats.iterations,
+           (double)sstats.iterations/sstats.signatures);
+    printf("rejections: w0 %llu, z %llu, ct0 %llu, hint %llu\n",
+           sstats.rejections[SIGNSTATS_REJECT_W0],
+           sstats.rejections[SIGNSTATS_REJECT_Z],
+           sstats.rejections[SIGNSTATS_REJECT_CT0],
+           sstats.rejections[SIGNSTATS_REJECT_HINT]);
+    for(i = 0; i < SIGNSTATS_MAX_ITERATIONS; ++i)
+      if(sstats.histogram[i])
+        printf("%2u%s iterations: %llu\n", i + 1,
+               i == SIGNSTATS_MAX_ITERATIONS - 1 ? "+" : "",
+               sstats.histogram[i]);
+    printf("\n");
+  }
+#endif
 
 #ifdef DBENCH
-  print_results("modular reduction:", t[0], NTESTS);
-  print_results("addition:", t[1], NTESTS);
-  print_results("multiplication:", t[2], NTESTS);
-  print_results("rounding:", t[3], NTESTS);
-  print_results("rejection sampling:", t[4], NTESTS);
-  print_results("packing:", t[5], NTESTS);
-  print_results("SHAKE:", t[6], NTESTS);
+  print_results("modular reduction", t[0], NTESTS);
+  print_results("addition", t[1], NTESTS);
+  print_results("multiplication", t[2], NTESTS);
+  print_results("rounding", t[3], NTESTS);
+  print_results("rejection sampling", t[4], NTESTS);
+  print_results("packing", t[5], NTESTS);
+  print_results("SHAKE", t[6], NTESTS);
 #endif
 
+  print_end();
   return 0;
 }
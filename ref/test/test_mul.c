@@ -61,7 +61,7 @@ int main(void) {
         printf("FAILURE: c2[%u] = %u != %u\n", j, c2.coeffs[j], c1.coeffs[j]);
   }
 
-  print_results("naive: ", t1, NTESTS);
-  print_results("ntt: ", t2, NTESTS);
+  print_results("naive", t1, NTESTS);
+  print_results("ntt", t2, NTESTS);
   return 0;
 }
@@ -0,0 +1,175 @@
+#include <pthread.h>
+#include <sched.h>
+#include "threadpool.h"
+
+/*
+ * Minimal fork-join thread pool for splitting the independent polynomial
+ * operations of a single signing call over several cores. A job consists of
+ * ntasks indices that are handed out through an atomic counter; the calling
+ * thread works on the job as well and returns when all tasks are done.
+ * Jobs are announced by incrementing a generation counter. Idle workers poll
+ * it for THREADPOOL_SPIN rounds, yielding in between, before they block on
+ * a condition variable, so back-to-back jobs do not pay for a wakeup.
+ */
+
+/*************************************************
+* Name:        threadpool_work
+*
+* Description: Claim and run tasks of the current job until none are left.
+*
+* Arguments:   - threadpool *pool: pointer to thread pool
+**************************************************/
+static void threadpool_work(threadpool *pool) {
+  unsigned int i;
+
+  while((i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED))
+        < pool->ntasks)
+    pool->fn(pool->arg, i);
+}
+
+/*************************************************
+* Name:        threadpool_worker
+*
+* Description: Main loop of worker threads.
+*
+* Arguments:   - void *arg: pointer to thread pool
+**************************************************/
+static void *threadpool_worker(void *arg) {
+  unsigned int spin;
+  unsigned long seen = 0;
+  threadpool *pool = arg;
+
+  for(;;) {
+    for(spin = 0; spin < THREADPOOL_SPIN; ++spin) {
+      if(__atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE) != seen)
+        break;
+      sched_yield();
+    }
+
+    if(spin == THREADPOOL_SPIN) {
+      pthread_mutex_lock(&pool->lock);
+      while(pool->generation == seen)
+        pthread_cond_wait(&pool->wake, &pool->lock);
+      pthread_mutex_unlock(&pool->lock);
+    }
+
+    seen = __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE);
+    if(pool->stop)
+      return NULL;
+
+    threadpool_work(pool);
+    __atomic_sub_fetch(&pool->active, 1, __ATOMIC_RELEASE);
+  }
+}
+
+/*************************************************
+* Name:        threadpool_init
+*
+* Description: Start thread pool with given number of worker threads. The
+*              thread calling threadpool_run also executes tasks, so a pool
+*              with n workers runs jobs on n + 1 threads. A pool without
+*              workers runs all tasks in the calling thread.
+*
+* Arguments:   - threadpool *pool: pointer to output thread pool
+*              - unsigned int nthreads: number of worker threads, at most
+*                                       THREADPOOL_MAX_THREADS
+*
+* Returns 0 on success and -1 if threads could not be started
+**************************************************/
+int threadpool_init(threadpool *pool, unsigned int nthreads) {
+  unsigned int i;
+
+  if(nthreads > THREADPOOL_MAX_THREADS)
+    return -1;
+
+  pool->nthreads = 0;
+  pool->ntasks = 0;
+  pool->next = 0;
+  pool->active = 0;
+  pool->generation = 0;
+  pool->stop = 0;
+  if(pthread_mutex_init(&pool->lock, NULL))
+    return -1;
+  if(pthread_cond_init(&pool->wake, NULL)) {
+    pthread_mutex_destroy(&pool->lock);
+    return -1;
+  }
+
+  for(i = 0; i < nthreads; ++i) {
+    if(pthread_create(&pool->threads[i], NULL, threadpool_worker, pool)) {
+      threadpool_free(pool);
+      return -1;
+    }
+    ++pool->nthreads;
+  }
+
+  return 0;
+}
+
+/*************************************************
+* Name:        threadpool_free
+*
+* Description: Stop and join all worker threads of thread pool. Must not be
+*              called while a job is running.
+*
+* Arguments:   - threadpool *pool: pointer to thread pool
+**************************************************/
+void threadpool_free(threadpool *pool) {
+  unsigned int i;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = 1;
+  __atomic_store_n(&pool->generation, pool->generation + 1, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+
+  for(i = 0; i < pool->nthreads; ++i)
+    pthread_join(pool->threads[i], NULL);
+
+  pool->nthreads = 0;
+  pthread_cond_destroy(&pool->wake);
+  pthread_mutex_destroy(&pool->lock);
+}
+
+/*************************************************
+* Name:        threadpool_run
+*
+* Description: Run fn(arg, i) for all i in [0, ntasks) on the threads of the
+*              pool and wait until all calls have returned. Tasks must be
+*              independent of each other. Only one thread may run jobs on a
+*              pool at a time.
+*
+* Arguments:   - threadpool *pool: pointer to thread pool, may be NULL to run
+*                                  all tasks in the calling thread
+*              - void (*fn)(void *, unsigned int): task function
+*              - void *arg: argument passed to every task
+*              - unsigned int ntasks: number of tasks
+**************************************************/
+void threadpool_run(threadpool *pool,
+                    void (*fn)(void *arg, unsigned int i),
+                    void *arg,
+                    unsigned int ntasks)
+{
+  unsigned int i;
+
+  if(!pool || !pool->nthreads || ntasks < 2) {
+    for(i = 0; i < ntasks; ++i)
+      fn(arg, i);
+    return;
+  }
+
+  pool->fn = fn;
+  pool->arg = arg;
+  pool->ntasks = ntasks;
+  pool->next = 0;
+  pool->active = pool->nthreads;
+
+  pthread_mutex_lock(&pool->lock);
+  __atomic_store_n(&pool->generation, pool->generation + 1, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+
+  threadpool_work(pool);
+  while(__atomic_load_n(&pool->active, __ATOMIC_ACQUIRE))
+    sched_yield();
+}
@@ -0,0 +1,30 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <pthread.h>
+
+#define THREADPOOL_MAX_THREADS 16
+#define THREADPOOL_SPIN 4096
+
+typedef struct {
+  pthread_t threads[THREADPOOL_MAX_THREADS];
+  unsigned int nthreads;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  void (*fn)(void *arg, unsigned int i);
+  void *arg;
+  unsigned int ntasks;
+  unsigned int next;
+  unsigned int active;
+  unsigned long generation;
+  int stop;
+} threadpool;
+
+int threadpool_init(threadpool *pool, unsigned int nthreads);
+void threadpool_free(threadpool *pool);
+void threadpool_run(threadpool *pool,
+                    void (*fn)(void *arg, unsigned int i),
+                    void *arg,
+                    unsigned int ntasks);
+
+#endif